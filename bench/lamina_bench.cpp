@@ -0,0 +1,277 @@
+/**
+ * Native benchmarks for the Lamina interpreter core
+ *
+ * Builds from the same sources as the WASM module, so regressions in the
+ * lexer, parser and evaluator can be measured and bisected on a plain
+ * host toolchain:
+ *
+ *   cmake -B build-native -DCMAKE_BUILD_TYPE=Release
+ *   cmake --build build-native --target lamina_bench
+ *   ./build-native/lamina_bench [--filter NAME] [--min-time MS] [--repetitions N]
+ *
+ * Output is a single JSON object on stdout. Benchmarks appear in a fixed
+ * order and the output holds no timestamps or host details, so two runs
+ * can be diffed directly.
+ *
+ * The loop.* benchmarks run the same tight loop on a bare Interpreter
+ * (baseline), through LaminaInterpreter with no limits set (wrapper), and
+ * with a step limit (limits), i.e. with tick calls in every iteration. The
+ * wrapper should be no slower than the baseline.
+ */
+
+#include "../Lamina/interpreter/interpreter.hpp"
+#include "../Lamina/interpreter/ast.hpp"
+#include "../Lamina/interpreter/parser.hpp"
+#include "../Lamina/interpreter/lexer.hpp"
+#include "../Lamina/interpreter/value.hpp"
+#include "clock.hpp"
+#include "lamina_interpreter.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Keeps benchmark results observable so the work is not optimised away
+volatile size_t sink = 0;
+
+struct Options {
+    std::string filter;
+    double min_time_ms = 200;
+    int repetitions = 5;
+};
+
+struct Benchmark {
+    const char* name;
+    // Prepares state and returns the operation to time
+    std::function<std::function<void()>()> setup;
+};
+
+struct Result {
+    const char* name;
+    uint64_t iterations;
+    double median_ns;
+    double min_ns;
+};
+
+std::unique_ptr<Statement> parse_program(const std::string& code) {
+    auto tokens = Lexer::tokenize(code);
+    auto ast = Parser::parse(tokens);
+    return std::unique_ptr<Statement>(static_cast<Statement*>(ast.release()));
+}
+
+/**
+ * Parse a single expression, detached from its ExprStmt wrapper
+ */
+std::unique_ptr<Expression> parse_expression(const std::string& expression) {
+    auto ast = Parser::parse(Lexer::tokenize(expression + ";"));
+    auto* block = dynamic_cast<BlockStmt*>(ast.get());
+    auto* stmt = block && block->statements.size() == 1
+                     ? dynamic_cast<ExprStmt*>(block->statements[0].get())
+                     : nullptr;
+    if (!stmt || !stmt->expr) {
+        throw std::runtime_error("Expected a single expression: " + expression);
+    }
+    return std::move(stmt->expr);
+}
+
+/**
+ * A program of the size of a typical script, for the lexer and parser
+ */
+std::string sample_program() {
+    std::string code;
+    for (int i = 0; i < 100; ++i) {
+        std::string n = std::to_string(i);
+        code += "func f" + n + "(a, b) {\n";
+        code += "    var c = a * " + n + " + b / 3;\n";
+        code += "    if (c > 10) { return sqrt(c) + 1/2; } else { return c ^ 2; }\n";
+        code += "}\n";
+        code += "var x" + n + " = f" + n + "(" + n + ", 7);\n";
+        code += "print(\"x" + n + " =\", x" + n + ");\n";
+    }
+    return code;
+}
+
+/**
+ * Operation that runs a pre-parsed program
+ * @param setup Program run once before timing, e.g. to define variables
+ */
+std::function<void()> run_program(const std::string& setup, const std::string& code) {
+    auto interpreter = std::make_shared<Interpreter>();
+    if (!setup.empty()) {
+        interpreter->execute(parse_program(setup));
+    }
+    auto program = std::make_shared<std::unique_ptr<Statement>>(parse_program(code));
+    return [interpreter, program] {
+        interpreter->execute(*program);
+    };
+}
+
+/**
+ * Operation that evaluates a pre-parsed expression
+ */
+std::function<void()> eval_expression(const std::string& setup, const std::string& expression) {
+    auto interpreter = std::make_shared<Interpreter>();
+    if (!setup.empty()) {
+        interpreter->execute(parse_program(setup));
+    }
+    auto expr = std::shared_ptr<Expression>(parse_expression(expression));
+    return [interpreter, expr] {
+        sink = sink + interpreter->eval(expr.get()).to_string().size();
+    };
+}
+
+// A loop of 1000 iterations doing little besides the loop itself
+const char* const TIGHT_LOOP = "var i = 0; while (i < 1000) { i = i + 1; }";
+
+/**
+ * Operation that runs a program through the binding wrapper
+ * The parse cache is on, so only execution is timed, as in run_program()
+ * @param max_steps Step limit, 0 to run without limits
+ */
+std::function<void()> run_wrapped(const std::string& code, double max_steps) {
+    auto wrapper = std::make_shared<LaminaInterpreter>();
+    wrapper->enableParseCache(16, 1 << 20);
+    wrapper->setLimits(max_steps, 0);
+    auto source = std::make_shared<std::string>(code);
+    return [wrapper, source] {
+        if (wrapper->executeStatus(*source) != 0) {
+            throw std::runtime_error(wrapper->errorMessage());
+        }
+    };
+}
+
+const std::vector<Benchmark>& benchmarks() {
+    static const std::vector<Benchmark> list = {
+        {"lexer.tokenize", [] {
+             auto code = std::make_shared<std::string>(sample_program());
+             return std::function<void()>([code] {
+                 sink = sink + Lexer::tokenize(*code).size();
+             });
+         }},
+        {"parser.parse", [] {
+             auto tokens = std::make_shared<std::vector<Token>>(Lexer::tokenize(sample_program()));
+             return std::function<void()>([tokens] {
+                 sink = sink + (Parser::parse(*tokens) != nullptr);
+             });
+         }},
+        {"eval.arithmetic", [] {
+             return eval_expression("", "(1 + 2 * 3 - 4 / 2) * (5 + 6) ^ 2 - 7 % 3 + 8 * 9 / 12");
+         }},
+        {"eval.bigint_factorial", [] {
+             return run_program("", "bigint f = 500!;");
+         }},
+        {"eval.rational_sum", [] {
+             return run_program("", "var s = 0; var i = 1; while (i <= 200) { s = s + 1/i; i = i + 1; }");
+         }},
+        {"eval.det", [] {
+             return eval_expression(
+                 "var m = [[2, 0, 1, 3, 1], [1, 3, 2, 0, 4], [4, 1, 0, 2, 2], [0, 2, 3, 1, 5], [3, 1, 4, 1, 5]];",
+                 "det(m)");
+         }},
+        {"eval.symbolic_simplify", [] {
+             return eval_expression("", "sqrt(8) * sqrt(2) + sqrt(12) + sqrt(27) - sqrt(3) / 2");
+         }},
+        {"loop.baseline", [] {
+             return run_program("", TIGHT_LOOP);
+         }},
+        {"loop.wrapper", [] {
+             return run_wrapped(TIGHT_LOOP, 0);
+         }},
+        {"loop.limits", [] {
+             return run_wrapped(TIGHT_LOOP, 1e15);
+         }},
+    };
+    return list;
+}
+
+/**
+ * Time an operation
+ * Each repetition doubles the batch size until a batch takes at least
+ * min_time_ms; the reported times are per operation
+ */
+Result measure(const Benchmark& benchmark, const Options& options) {
+    auto operation = benchmark.setup();
+    operation();  // Warm-up, also surfaces errors before timing
+
+    std::vector<double> samples;
+    uint64_t iterations = 0;
+    for (int rep = 0; rep < options.repetitions; ++rep) {
+        uint64_t batch = 1;
+        while (true) {
+            double start = now_ms();
+            for (uint64_t i = 0; i < batch; ++i) {
+                operation();
+            }
+            double elapsed = now_ms() - start;
+            if (elapsed >= options.min_time_ms || batch >= (uint64_t(1) << 40)) {
+                samples.push_back(elapsed * 1e6 / static_cast<double>(batch));
+                iterations += batch;
+                break;
+            }
+            batch *= 2;
+        }
+    }
+
+    std::sort(samples.begin(), samples.end());
+    return Result{benchmark.name, iterations, samples[samples.size() / 2], samples.front()};
+}
+
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--filter") == 0 && value) {
+            options.filter = value;
+        } else if (std::strcmp(arg, "--min-time") == 0 && value) {
+            options.min_time_ms = std::atof(value);
+        } else if (std::strcmp(arg, "--repetitions") == 0 && value) {
+            options.repetitions = std::max(1, std::atoi(value));
+        } else {
+            std::fprintf(stderr, "Usage: %s [--filter NAME] [--min-time MS] [--repetitions N]\n", argv[0]);
+            return false;
+        }
+        ++i;
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        return 2;
+    }
+
+    std::vector<Result> results;
+    for (const auto& benchmark : benchmarks()) {
+        if (std::string(benchmark.name).find(options.filter) == std::string::npos) {
+            continue;
+        }
+        try {
+            results.push_back(measure(benchmark, options));
+        } catch (const std::exception& e) {
+            std::fprintf(stderr, "%s failed: %s\n", benchmark.name, e.what());
+            return 1;
+        }
+    }
+
+    std::printf("{\n  \"benchmarks\": [");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        std::printf("%s\n    {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.1f, \"min_ns_per_op\": %.1f}",
+                    i ? "," : "", result.name, static_cast<unsigned long long>(result.iterations),
+                    result.median_ns, result.min_ns);
+    }
+    std::printf("\n  ]\n}\n");
+    return 0;
+}
@@ -0,0 +1,122 @@
+/**
+ * Cold start benchmark: time from import to the first calc
+ *
+ * Every sample runs in a fresh Node.js process, so loading the module,
+ * compiling and instantiating the WASM, and constructing the first
+ * interpreter are all paid again. Run after yarn build:
+ *
+ *   node bench/startup.mjs [--runs N] [--backend NAME]...
+ *
+ * Backends default to all of wasm, wasm-simd, wasm-jspi and node, each
+ * requested through LAMINA_BACKEND (wasm-jspi is only used on request);
+ * those that are not built or not supported by this Node.js are listed under
+ * "unavailable". Output is a single JSON object on stdout with the median
+ * and minimum of each phase in milliseconds:
+ *
+ *   import     import('lamina.js'), which starts loading the module
+ *   init       await lamina.init(): the rest of instantiation
+ *   firstCalc  the first lamina.calc(), including interpreter setup
+ *   total      all of the above
+ */
+
+import { spawnSync } from 'node:child_process'
+
+const BACKENDS = ['wasm', 'wasm-simd', 'wasm-jspi', 'node']
+const PHASES = ['import', 'init', 'firstCalc', 'total']
+
+const entry = new URL('../lib/index.mjs', import.meta.url).href
+
+// Runs in the child process; prints the timings of one cold start
+const probe = `
+const start = performance.now()
+const { lamina } = await import(${JSON.stringify(entry)})
+const imported = performance.now()
+await lamina.init()
+const ready = performance.now()
+lamina.calc('1 + 1')
+const done = performance.now()
+console.log(JSON.stringify({
+  backend: lamina.backend,
+  import: imported - start,
+  init: ready - imported,
+  firstCalc: done - ready,
+  total: done - start
+}))
+`
+
+function parseArgs(argv) {
+  const options = { runs: 10, backends: [] }
+  for (let i = 0; i < argv.length; i++) {
+    if (argv[i] === '--runs' && i + 1 < argv.length) {
+      options.runs = Math.max(1, Number.parseInt(argv[++i], 10) || 1)
+    } else if (argv[i] === '--backend' && i + 1 < argv.length) {
+      options.backends.push(argv[++i])
+    } else {
+      console.error(
+        'Usage: node bench/startup.mjs [--runs N] [--backend NAME]...'
+      )
+      process.exit(1)
+    }
+  }
+  if (options.backends.length === 0) {
+    options.backends = BACKENDS
+  }
+  return options
+}
+
+/**
+ * Start a process on the given backend and time its first calc
+ * @returns {object | null} Timings, or null if the backend did not load
+ */
+function sample(backend) {
+  const child = spawnSync(
+    process.execPath,
+    ['--input-type=module', '--eval', probe],
+    {
+      env: { ...process.env, LAMINA_BACKEND: backend },
+      encoding: 'utf-8'
+    }
+  )
+  if (child.status !== 0) {
+    throw new Error(`Startup on ${backend} failed:\n${child.stderr}`)
+  }
+  const timings = JSON.parse(child.stdout.trim().split('\n').pop())
+  // The wrapper falls back to another backend when the requested one is
+  // missing or unsupported
+  return timings.backend === backend ? timings : null
+}
+
+function summarize(values) {
+  const sorted = [...values].sort((a, b) => a - b)
+  const round = (ms) => Math.round(ms * 1000) / 1000
+  return {
+    median: round(sorted[Math.floor(sorted.length / 2)]),
+    min: round(sorted[0])
+  }
+}
+
+const options = parseArgs(process.argv.slice(2))
+const results = []
+const unavailable = []
+
+for (const backend of options.backends) {
+  const samples = []
+  for (let i = 0; i < options.runs; i++) {
+    const timings = sample(backend)
+    if (!timings) {
+      break
+    }
+    samples.push(timings)
+  }
+  if (samples.length === 0) {
+    unavailable.push(backend)
+    continue
+  }
+  const result = { backend, runs: samples.length }
+  for (const phase of PHASES) {
+    result[`${phase}_ms`] = summarize(samples.map((s) => s[phase]))
+  }
+  results.push(result)
+}
+
+console.log(JSON.stringify({ startup: results, unavailable }, null, 2))
@@ -0,0 +1,201 @@
+#pragma once
+
+#include "../Lamina/interpreter/interpreter.hpp"
+#include "../Lamina/interpreter/value.hpp"
+#include "clock.hpp"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Per-builtin call statistics
+ *
+ * Profiling works by replacing entries of Interpreter::builtin_functions
+ * with a ProfiledBuiltin that wraps the original function, and putting the
+ * original back when profiling is turned off. A disabled profiler leaves
+ * the dispatch path untouched.
+ *
+ * The wrappers also serve a slow-call hook (used for tracing), which can
+ * be set independently of collecting statistics.
+ */
+class BuiltinProfiler {
+public:
+    using Builtin = decltype(std::declval<Interpreter&>().builtin_functions)::mapped_type;
+    using SlowHook = std::function<void(const std::string& name, double start_ms, double elapsed_ms)>;
+
+    // Argument types tracked by the histogram, see arg_type()
+    static constexpr std::array<const char*, 12> ARG_TYPES = {
+        "null", "bool", "int", "float", "string", "bigint",
+        "rational", "irrational", "symbolic", "array", "matrix", "other"};
+
+    struct Entry {
+        uint64_t calls = 0;
+        double total_ms = 0;
+        double self_ms = 0;
+        std::array<uint64_t, ARG_TYPES.size()> arg_types{};
+    };
+
+    /**
+     * Wrapper installed in place of a builtin while profiling
+     */
+    struct ProfiledBuiltin {
+        Builtin original;
+        BuiltinProfiler* profiler;
+        const std::string* name;
+        Entry* entry;
+
+        Value operator()(const std::vector<Value>& args) const {
+            Frame frame(*profiler, *name, *entry);
+            if (profiler->active) {
+                for (const auto& arg : args) {
+                    ++entry->arg_types[arg_type(arg)];
+                }
+            }
+            return original(args);
+        }
+    };
+
+    bool enabled() const {
+        return active;
+    }
+
+    void set_enabled(bool enabled) {
+        active = enabled;
+    }
+
+    /**
+     * Call hook for every builtin call that takes at least threshold_ms
+     * @param hook Callback, or an empty function to remove it
+     */
+    void set_slow_hook(double threshold_ms, SlowHook hook) {
+        slow_threshold_ms = threshold_ms;
+        slow_hook = std::move(hook);
+    }
+
+    /**
+     * Whether builtins need to be wrapped
+     */
+    bool wrapping() const {
+        return active || slow_hook;
+    }
+
+    /**
+     * Bring the builtins of an interpreter in line with the profiler state
+     * Wraps every builtin while wrapping() and unwraps them otherwise.
+     * Wrappers installed by another profiler (in state adopted from another
+     * wrapper) are replaced either way. Internal builtins are skipped
+     */
+    void apply(Interpreter& interpreter) {
+        for (auto& [name, function] : interpreter.builtin_functions) {
+            if (name.rfind("__lamina_", 0) == 0) {
+                continue;
+            }
+            if (auto* wrapped = function.template target<ProfiledBuiltin>()) {
+                if (wrapping() && wrapped->profiler == this) {
+                    continue;
+                }
+                Builtin original = std::move(wrapped->original);
+                function = std::move(original);
+            }
+            if (wrapping()) {
+                auto entry = entries.try_emplace(name).first;
+                function = ProfiledBuiltin{std::move(function), this, &entry->first, &entry->second};
+            }
+        }
+    }
+
+    /**
+     * Whether apply() would change anything, without touching the state
+     */
+    bool needs_apply(const Interpreter& interpreter) const {
+        for (const auto& [name, function] : interpreter.builtin_functions) {
+            if (name.rfind("__lamina_", 0) == 0) {
+                continue;
+            }
+            const auto* wrapped = function.template target<ProfiledBuiltin>();
+            if (wrapping() ? (!wrapped || wrapped->profiler != this) : wrapped != nullptr) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Zero all statistics
+     * Entries are kept because installed wrappers point at them
+     */
+    void reset() {
+        for (auto& [name, entry] : entries) {
+            entry = Entry{};
+        }
+    }
+
+    const std::unordered_map<std::string, Entry>& results() const {
+        return entries;
+    }
+
+    static size_t arg_type(const Value& value) {
+        if (value.is_null()) return 0;
+        if (value.is_bool()) return 1;
+        if (value.is_int()) return 2;
+        if (value.is_float()) return 3;
+        if (value.is_string()) return 4;
+        if (value.is_bigint()) return 5;
+        if (value.is_rational()) return 6;
+        if (value.is_irrational()) return 7;
+        if (value.is_symbolic()) return 8;
+        if (value.is_array()) return 9;
+        if (value.is_matrix()) return 10;
+        return 11;
+    }
+
+private:
+    /**
+     * Times one builtin call; time spent in nested builtin calls is
+     * subtracted from the caller's self time
+     */
+    class Frame {
+    public:
+        Frame(BuiltinProfiler& profiler, const std::string& name, Entry& entry)
+            : profiler(profiler), name(name), entry(entry), parent(profiler.current), start(now_ms()) {
+            profiler.current = this;
+        }
+
+        ~Frame() {
+            double elapsed = now_ms() - start;
+            if (profiler.active) {
+                ++entry.calls;
+                entry.total_ms += elapsed;
+                entry.self_ms += elapsed - child_ms;
+            }
+            if (parent) {
+                parent->child_ms += elapsed;
+            }
+            profiler.current = parent;
+            if (profiler.slow_hook && elapsed >= profiler.slow_threshold_ms) {
+                profiler.slow_hook(name, start, elapsed);
+            }
+        }
+
+        Frame(const Frame&) = delete;
+        Frame& operator=(const Frame&) = delete;
+
+    private:
+        BuiltinProfiler& profiler;
+        const std::string& name;
+        Entry& entry;
+        Frame* parent;
+        double start;
+        double child_ms = 0;
+    };
+
+    bool active = false;
+    double slow_threshold_ms = 0;
+    SlowHook slow_hook;
+    Frame* current = nullptr;
+    std::unordered_map<std::string, Entry> entries;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten/emscripten.h>
+#else
+#include <chrono>
+#endif
+
+/**
+ * Monotonic time in milliseconds
+ * Uses performance.now() under Emscripten and steady_clock natively
+ */
+inline double now_ms() {
+#ifdef __EMSCRIPTEN__
+    return emscripten_get_now();
+#else
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
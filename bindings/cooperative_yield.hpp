@@ -0,0 +1,124 @@
+#pragma once
+
+#include "clock.hpp"
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+#ifdef LAMINA_JSPI
+#include <emscripten/emscripten.h>
+#endif
+
+/**
+ * Yield points of executeAsync()
+ *
+ * Checked from the tick builtin (see instrument_ticks), i.e. once per loop
+ * iteration and user function call. When a slice of steps or milliseconds
+ * has been used up, the running call suspends and returns to the event
+ * loop through JS Promise Integration, resuming in a later task. Only the
+ * JSPI build (LAMINA_JSPI) can suspend on its own; other embedders can
+ * pass a Suspend callback that does it for them, as the Node-API addon
+ * does. Without either, executeAsync() runs to completion and no slice is
+ * ever due.
+ */
+class CooperativeYield {
+public:
+    static constexpr uint64_t CLOCK_INTERVAL = 256;
+
+    /**
+     * Returns to the event loop and comes back once it has run a task
+     */
+    using Suspend = std::function<void()>;
+
+    /**
+     * Whether this build can suspend a running call without a Suspend
+     */
+    static constexpr bool supported() {
+#ifdef LAMINA_JSPI
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * Start yielding for the current call
+     * @param slice_steps Steps between yields, 0 for no step slice
+     * @param slice_ms Milliseconds between yields, 0 for no time slice
+     * @param suspend How to suspend, nullptr for the build's own way
+     */
+    void begin(double slice_steps, double slice_ms, Suspend suspend = nullptr) {
+        step_slice = slice_steps > 0 ? static_cast<uint64_t>(slice_steps) : 0;
+        time_slice = slice_ms > 0 ? slice_ms : 0;
+        suspender = std::move(suspend);
+        armed = (supported() || suspender) && (step_slice > 0 || time_slice > 0);
+        yield_count = 0;
+        start_slice();
+    }
+
+    void end() {
+        armed = false;
+        suspender = nullptr;
+    }
+
+    /**
+     * Whether the current call may yield
+     */
+    bool active() const {
+        return armed;
+    }
+
+    /**
+     * Whether the current slice is used up; called once per step
+     */
+    bool due() {
+        if (!armed) {
+            return false;
+        }
+        ++slice_steps_taken;
+        if (step_slice > 0 && slice_steps_taken >= step_slice) {
+            return true;
+        }
+        return time_slice > 0 && slice_steps_taken % CLOCK_INTERVAL == 0 && now_ms() >= slice_deadline;
+    }
+
+    /**
+     * Suspend until the event loop has run, then start a new slice
+     * @return Milliseconds spent suspended
+     */
+    double suspend() {
+        double start = now_ms();
+        if (suspender) {
+            suspender();
+        } else {
+#ifdef LAMINA_JSPI
+            // A macrotask, so rendering and I/O get a turn, not just microtasks
+            emscripten_sleep(0);
+#endif
+        }
+        ++yield_count;
+        start_slice();
+        return now_ms() - start;
+    }
+
+    /**
+     * Number of times the last executeAsync() call yielded
+     */
+    uint64_t yields() const {
+        return yield_count;
+    }
+
+private:
+    uint64_t step_slice = 0;
+    double time_slice = 0;
+    bool armed = false;
+    Suspend suspender;
+    uint64_t slice_steps_taken = 0;
+    double slice_deadline = 0;
+    uint64_t yield_count = 0;
+
+    void start_slice() {
+        slice_steps_taken = 0;
+        slice_deadline = time_slice > 0 ? now_ms() + time_slice : 0;
+    }
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+
+/**
+ * Error categories of the status ABI
+ * The numeric values are part of the JS interface (see src/interpreter.ts)
+ */
+enum class ErrorKind : int {
+    None = 0,
+    Syntax = 1,   // Lexing or parsing failed
+    Runtime = 2,  // RuntimeError raised by the interpreter
+    StdLib = 3,   // StdLibException raised by a builtin
+    Native = 4,   // Any other std::exception
+    Unknown = 5,  // Non-standard exception
+    Limit = 6,    // Step or time limit exceeded, see setLimits()
+    Memory = 7    // Memory quota exceeded, see setMemoryQuota()
+};
+
+/**
+ * Details of the last failed call
+ * Only written on failure, so successful calls do no diagnostic work
+ */
+struct Diagnostic {
+    ErrorKind kind = ErrorKind::None;
+    std::string message;
+    // Byte offset into the source, or -1 when the error has no location
+    int offset = -1;
+
+    int fail(ErrorKind error_kind, const char* error_message, int error_offset = -1) {
+        kind = error_kind;
+        message = error_message;
+        offset = error_offset;
+        return static_cast<int>(kind);
+    }
+};
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "../Lamina/interpreter/ast.hpp"
+#include "clock.hpp"
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Thrown when a call exceeds its step or time budget
+ */
+class LimitExceeded : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * Step and wall-clock budget of the current call
+ *
+ * Once limits or yield slices are in use, programs and expressions are
+ * instrumented with calls to the TICK_BUILTIN builtin at the start of every
+ * block (see instrument_ticks), so each loop iteration and user function
+ * call is one step; until then code runs without them. tick() costs a
+ * counter increment and a compare; the clock is only read every
+ * CLOCK_INTERVAL steps. The budget applies between begin() and end(), i.e. for the
+ * duration of one call into the wrapper (see Scope); ticks outside a call
+ * count nothing.
+ */
+class ExecutionLimits {
+public:
+    // Not a valid identifier, so scripts can neither call nor redefine it
+    static constexpr const char* TICK_BUILTIN = "__lamina_tick@";
+    static constexpr uint64_t CLOCK_INTERVAL = 256;
+
+    /**
+     * Applies the budget to one call while in scope
+     */
+    class Scope {
+    public:
+        explicit Scope(ExecutionLimits& limits) : limits(limits) {
+            limits.begin();
+        }
+        ~Scope() { limits.end(); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        ExecutionLimits& limits;
+    };
+
+    /**
+     * Set the budget applied to subsequent calls; 0 means unlimited
+     */
+    void configure(double max_steps, double timeout_ms) {
+        step_budget = max_steps > 0 ? static_cast<uint64_t>(max_steps) : 0;
+        time_budget = timeout_ms > 0 ? timeout_ms : 0;
+    }
+
+    bool active() const {
+        return step_budget > 0 || time_budget > 0;
+    }
+
+    /**
+     * Start a call: reset the step counter and arm the deadline
+     */
+    void begin() {
+        step_count = 0;
+        exceeded = false;
+        deadline = time_budget > 0 ? now_ms() + time_budget : 0;
+        running = true;
+    }
+
+    /**
+     * End the call; the step count and tripped() stay readable
+     */
+    void end() {
+        running = false;
+    }
+
+    void tick() {
+        if (!running) {
+            return;
+        }
+        ++step_count;
+        if (step_budget > 0 && step_count > step_budget) {
+            trip("Step limit of " + std::to_string(step_budget) + " exceeded");
+        }
+        if (deadline > 0 && step_count % CLOCK_INTERVAL == 0 && now_ms() > deadline) {
+            trip("Time limit of " + std::to_string(static_cast<uint64_t>(time_budget)) + " ms exceeded");
+        }
+    }
+
+    /**
+     * Push the deadline back by time the call spent suspended, so that
+     * yielding to the event loop does not count against the time budget
+     */
+    void extend(double ms) {
+        if (deadline > 0) {
+            deadline += ms;
+        }
+    }
+
+    /**
+     * Whether the last call was aborted by a limit
+     * Checked by the caller because the interpreter may rewrap the exception
+     */
+    bool tripped() const {
+        return exceeded;
+    }
+
+    uint64_t steps() const {
+        return step_count;
+    }
+
+private:
+    uint64_t step_budget = 0;
+    double time_budget = 0;
+    uint64_t step_count = 0;
+    double deadline = 0;
+    bool exceeded = false;
+    bool running = false;
+
+    [[noreturn]] void trip(const std::string& message) {
+        exceeded = true;
+        throw LimitExceeded(message);
+    }
+};
+
+inline void instrument_ticks(Statement* stmt);
+inline void instrument_ticks(Expression* expr);
+
+/**
+ * Whether a statement is a tick call inserted by instrument_ticks()
+ */
+inline bool is_tick(const Statement* stmt) {
+    auto* expr = dynamic_cast<const ExprStmt*>(stmt);
+    auto* call = expr ? dynamic_cast<const CallExpr*>(expr->expr.get()) : nullptr;
+    return call && call->callee == ExecutionLimits::TICK_BUILTIN;
+}
+
+/**
+ * Instrument a loop, branch or function body
+ * A body that is a single statement rather than a block is wrapped in one,
+ * so that it has a start to tick at
+ */
+template <typename Body>
+void instrument_body(std::unique_ptr<Body>& body) {
+    if (!body) {
+        return;
+    }
+    if constexpr (!std::is_same_v<Body, BlockStmt>) {
+        if (!dynamic_cast<BlockStmt*>(body.get())) {
+            auto block = std::make_unique<BlockStmt>();
+            block->statements.push_back(std::move(body));
+            body = std::move(block);
+        }
+    }
+    instrument_ticks(static_cast<Statement*>(body.get()));
+}
+
+/**
+ * Insert a call to the tick builtin at the start of every block
+ * Covers nested blocks, if/else branches, while bodies, function bodies
+ * and the bodies of lambdas anywhere in an expression. A block that
+ * already starts with a tick was instrumented with everything in it, so
+ * instrumenting twice, e.g. a function body shared by two forks, changes
+ * nothing
+ */
+inline void instrument_ticks(Statement* stmt) {
+    if (!stmt) {
+        return;
+    }
+
+    if (auto* block = dynamic_cast<BlockStmt*>(stmt)) {
+        if (!block->statements.empty() && is_tick(block->statements.front().get())) {
+            return;
+        }
+        for (auto& child : block->statements) {
+            instrument_ticks(child.get());
+        }
+        auto call = std::make_unique<CallExpr>(ExecutionLimits::TICK_BUILTIN,
+                                               std::vector<std::unique_ptr<Expression>>{});
+        block->statements.insert(block->statements.begin(), std::make_unique<ExprStmt>(std::move(call)));
+    } else if (auto* branch = dynamic_cast<IfStmt*>(stmt)) {
+        instrument_ticks(branch->condition.get());
+        instrument_body(branch->thenBlock);
+        instrument_body(branch->elseBlock);
+    } else if (auto* loop = dynamic_cast<WhileStmt*>(stmt)) {
+        instrument_ticks(loop->condition.get());
+        instrument_body(loop->body);
+    } else if (auto* func = dynamic_cast<FuncDefStmt*>(stmt)) {
+        instrument_body(func->body);
+    } else if (auto* expr = dynamic_cast<ExprStmt*>(stmt)) {
+        instrument_ticks(expr->expr.get());
+    } else if (auto* ret = dynamic_cast<ReturnStmt*>(stmt)) {
+        instrument_ticks(ret->expr.get());
+    } else if (auto* decl = dynamic_cast<VarDeclStmt*>(stmt)) {
+        instrument_ticks(decl->expr.get());
+    } else if (auto* assign = dynamic_cast<AssignStmt*>(stmt)) {
+        instrument_ticks(assign->expr.get());
+    }
+}
+
+/**
+ * Instrument the lambda bodies in an expression
+ */
+inline void instrument_ticks(Expression* expr) {
+    if (!expr) {
+        return;
+    }
+
+    if (auto* binary = dynamic_cast<BinaryExpr*>(expr)) {
+        instrument_ticks(binary->left.get());
+        instrument_ticks(binary->right.get());
+    } else if (auto* unary = dynamic_cast<UnaryExpr*>(expr)) {
+        instrument_ticks(unary->operand.get());
+    } else if (auto* call = dynamic_cast<CallExpr*>(expr)) {
+        for (auto& arg : call->args) {
+            instrument_ticks(arg.get());
+        }
+    } else if (auto* lambda = dynamic_cast<LambdaDeclExpr*>(expr)) {
+        instrument_body(lambda->body);
+    }
+}
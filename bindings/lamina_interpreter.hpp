@@ -0,0 +1,1399 @@
+#pragma once
+
+#include "../Lamina/interpreter/interpreter.hpp"
+#include "../Lamina/interpreter/ast.hpp"
+#include "../Lamina/interpreter/parser.hpp"
+#include "../Lamina/interpreter/lexer.hpp"
+#include "../Lamina/interpreter/value.hpp"
+#include "builtin_profiler.hpp"
+#include "cooperative_yield.hpp"
+#include "diagnostic.hpp"
+#include "execution_limits.hpp"
+#include "line_profiler.hpp"
+#include "memory_accounting.hpp"
+#include "numeric_kernel.hpp"
+#include "output_buffer.hpp"
+#include "parse_cache.hpp"
+#include "trace_recorder.hpp"
+#include "vector_builtins.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Declare the print function from stdio.cpp
+// Output goes through the interpreter's OutputBuffer instead of a
+// per-line std::endl flush
+inline Value print_wasm(const std::vector<Value>& args, OutputBuffer& output) {
+    for (size_t i = 0; i < args.size(); ++i) {
+        output.append(args[i].to_string());
+        if (i != args.size() - 1) {
+            output.append(' ');
+        }
+    }
+    output.append('\n');
+    output.maybe_flush();
+    return Value();
+}
+
+/**
+ * Tokenize and parse a Lamina program
+ * @param code The Lamina source code
+ * @param tokens_out If set, receives the tokens the program was parsed from
+ * @return Parsed program
+ */
+inline std::unique_ptr<Statement> parse_program(const std::string& code, std::vector<Token>* tokens_out = nullptr) {
+    // Tokenize - static method
+    std::vector<Token> tokens;
+    {
+        TraceSpan span("phase", "lex");
+        tokens = Lexer::tokenize(code);
+    }
+
+    // Parse - static method
+    std::unique_ptr<ASTNode> ast;
+    {
+        TraceSpan span("phase", "parse");
+        ast = Parser::parse(tokens);
+    }
+    if (tokens_out) {
+        *tokens_out = std::move(tokens);
+    }
+
+    // Cast ASTNode to Statement (Parser::parse returns a BlockStmt which is a Statement)
+    return std::unique_ptr<Statement>(static_cast<Statement*>(ast.release()));
+}
+
+/**
+ * Parse a single Lamina expression into an AST
+ * The expression is parsed as a one-statement program and the expression
+ * node is detached from its ExprStmt wrapper, so it can be evaluated directly.
+ * @param expression The Lamina expression to parse
+ * @return Parsed expression node
+ */
+inline std::unique_ptr<Expression> parse_expression(const std::string& expression) {
+    // Accept a trailing semicolon, as in "2 + 3;"
+    size_t end = expression.find_last_not_of(" \t\r\n;");
+    if (end == std::string::npos) {
+        throw std::runtime_error("Empty expression");
+    }
+
+    std::vector<Token> tokens;
+    {
+        TraceSpan span("phase", "lex");
+        tokens = Lexer::tokenize(expression.substr(0, end + 1) + ";");
+    }
+    std::unique_ptr<ASTNode> ast;
+    {
+        TraceSpan span("phase", "parse");
+        ast = Parser::parse(tokens);
+    }
+
+    auto* block = dynamic_cast<BlockStmt*>(ast.get());
+    if (!block || block->statements.size() != 1) {
+        throw std::runtime_error("Expected a single expression");
+    }
+
+    auto* expr_stmt = dynamic_cast<ExprStmt*>(block->statements[0].get());
+    if (!expr_stmt || !expr_stmt->expr) {
+        throw std::runtime_error("Expected an expression, got a statement");
+    }
+
+    return std::move(expr_stmt->expr);
+}
+
+/**
+ * Fully initialized interpreter state that new wrappers start from
+ * Building an Interpreter registers every builtin of the standard library;
+ * this is done once per thread, after which a LaminaInterpreter shares the
+ * state copy-on-write like a fork. It is built on first use, after every
+ * static initializer of the Lamina core has run; the bindings' warmUp()
+ * builds it as soon as the module is loaded
+ */
+inline const std::shared_ptr<Interpreter>& prototype_interpreter() {
+    static thread_local const std::shared_ptr<Interpreter> prototype = [] {
+        auto state = std::make_shared<Interpreter>();
+        VectorBuiltins::install(*state);
+        return state;
+    }();
+    return prototype;
+}
+
+/**
+ * Captured interpreter state, see LaminaInterpreter::snapshot()
+ */
+struct InterpreterSnapshot {
+    std::shared_ptr<Interpreter> state;
+};
+
+/**
+ * Packed results of LaminaInterpreter::evalBatch()
+ * Result i occupies bytes [offsets[i], offsets[i + 1]) of data;
+ * errors[i] is the ErrorKind of item i when it is an error message, 0
+ * when it succeeded
+ */
+struct BatchResult {
+    std::string data;
+    std::vector<uint32_t> offsets;
+    std::vector<uint8_t> errors;
+};
+
+/**
+ * LaminaInterpreter wrapper for JavaScript
+ * Provides a simple interface to execute Lamina code from JavaScript/Node.js
+ *
+ * The class is shared by the embind module (wasm_bindings.cpp) and the
+ * Node-API addon (napi_bindings.cpp). Methods that produce JS objects are
+ * implemented by each binding on top of the plain C++ accessors below, and
+ * methods taking buffers receive native pointers.
+ */
+class LaminaInterpreter {
+private:
+    // Interpreter state, shared copy-on-write with snapshots; a shared
+    // instance is never mutated, writable() copies it first
+    std::shared_ptr<Interpreter> interpreter;
+
+    // Warm state captured right after construction, used by reset()
+    std::shared_ptr<Interpreter> baseline;
+
+    // Whether instance-bound builtins (print) point at this wrapper
+    bool builtins_bound = false;
+
+    // Whether the state still holds what reset() would restore, i.e. no
+    // call has asked for writable() since
+    bool pristine = true;
+
+    // Whether the state holds what prototype_interpreter() holds: no user
+    // definitions and no builtins bound to any wrapper
+    bool clean = false;
+
+    // Compiled expressions, keyed by the handle returned to JavaScript
+    std::unordered_map<int, std::unique_ptr<Expression>> compiled_expressions;
+    int next_handle = 1;
+    std::string last_error;
+
+    // Packed evalBatch() results, reused across calls
+    BatchResult batch;
+
+    // Output written by print()
+    OutputBuffer output;
+
+    // Parsed programs reused by execute(), disabled by default
+    ParseCache parse_cache;
+
+    // Status ABI: details of the last failure and the last evalStatus() result
+    Diagnostic diagnostic;
+    Value last_result;
+
+    // Step and time budget of every call that runs Lamina code, counted
+    // by the tick calls programs carry once ticks_armed is set
+    ExecutionLimits limits;
+    bool ticks_armed = false;
+
+    // Slices of executeAsync(), checked at the same checkpoints as limits
+    CooperativeYield yielder;
+
+    // UTF-8 source received by appendSource(), run by finishSource()
+    std::string pending_source;
+
+    // Heap charged to this wrapper by the calls that run Lamina code
+    MemoryAccount* memory = MemoryAccount::create();
+
+    // Builtin call statistics, off by default
+    BuiltinProfiler profiler;
+
+    // Per-line statistics; programs parsed while enabled carry probes
+    LineProfiler line_profiler;
+
+    // Trace of execute()/eval() calls, exported as Chrome trace JSON
+    TraceRecorder tracer;
+
+    enum class Stage { Parse, Evaluate };
+
+    /**
+     * Error kind of a failure in the given stage
+     * A tripped limit wins, whatever the interpreter wrapped it in
+     */
+    ErrorKind kind_for(Stage stage, ErrorKind evaluate_kind) const {
+        if (limits.tripped()) {
+            return ErrorKind::Limit;
+        }
+        if (memory->tripped()) {
+            return ErrorKind::Memory;
+        }
+        return stage == Stage::Parse ? ErrorKind::Syntax : evaluate_kind;
+    }
+
+    /**
+     * Run a call body and translate exceptions into a status code
+     * The body receives the current stage and advances it once parsing is
+     * done, so any failure before that is reported as a syntax error
+     * @param name Name of the call in traces
+     * @return 0 on success, otherwise the ErrorKind of the failure
+     */
+    template <typename Body>
+    int guarded(const char* name, Body&& body) {
+        TraceRecorder::Scope tracing(tracer);
+        TraceSpan span("call", name);
+        Stage stage = Stage::Parse;
+        int status = 0;
+        ExecutionLimits::Scope budget(limits);
+        if (line_profiler.enabled()) {
+            line_profiler.begin(memory);
+        }
+        try {
+            MemoryAccount::Scope charge(memory);
+            body(stage);
+        } catch (const RuntimeError& e) {
+            status = diagnostic.fail(kind_for(stage, ErrorKind::Runtime), e.what());
+        } catch (const StdLibException& e) {
+            status = diagnostic.fail(kind_for(stage, ErrorKind::StdLib), e.what());
+        } catch (const std::exception& e) {
+            status = diagnostic.fail(kind_for(stage, ErrorKind::Native), e.what());
+        } catch (...) {
+            status = diagnostic.fail(ErrorKind::Unknown, "Unknown C++ exception occurred during execution");
+        }
+        line_profiler.finish();
+        tracer.close_functions();
+        return status;
+    }
+
+    /**
+     * Format the last failure the way the string-returning API always has
+     * @param fallback Prefix for errors that are not RuntimeError/StdLibException
+     */
+    std::string format_error(const char* fallback) const {
+        switch (diagnostic.kind) {
+        case ErrorKind::Runtime:
+            return "RuntimeError: " + diagnostic.message;
+        case ErrorKind::StdLib:
+            return "StdLibException: " + diagnostic.message;
+        case ErrorKind::Unknown:
+            return diagnostic.message;
+        case ErrorKind::Limit:
+            return "LimitExceeded: " + diagnostic.message;
+        case ErrorKind::Memory:
+            return "MemoryError: " + diagnostic.message;
+        default:
+            return fallback + diagnostic.message;
+        }
+    }
+
+    /**
+     * Report an execution error on stderr, after any pending output
+     */
+    void report_error(const std::string& message) {
+        output.flush();
+        std::cerr << message << std::endl;
+    }
+
+    /**
+     * Return to the event loop in the middle of executeAsync()
+     * Output so far is written out first. While suspended, other
+     * interpreters may run on this thread, so none of this one's accounting
+     * or tracing is left current
+     */
+    void suspend() {
+        output.flush();
+        MemoryAccount::Scope pause(nullptr);
+        TraceRecorder::Scope no_trace(nullptr);
+        limits.extend(yielder.suspend());
+    }
+
+    /**
+     * Start instrumenting code with tick calls, see ExecutionLimits
+     * Done when limits or yield slices are first in use, so code never pays
+     * for ticks before that. User functions defined so far, cached programs
+     * and compiled expressions are instrumented here; everything parsed
+     * afterwards as it is parsed. Lambdas already stored in variables are
+     * out of reach and keep running without ticks
+     */
+    void arm_ticks() {
+        if (ticks_armed) {
+            return;
+        }
+        ticks_armed = true;
+        // Instrumenting a function body shared with a snapshot or fork is
+        // harmless: ticks do nothing outside a limited call
+        MemoryAccount::Scope pause(nullptr);
+        for (auto& [name, function] : interpreter->functions) {
+            instrument_body(function->body);
+        }
+        parse_cache.for_each([](std::unique_ptr<Statement>& ast) {
+            instrument_ticks(ast.get());
+        });
+        for (auto& [handle, expr] : compiled_expressions) {
+            instrument_ticks(expr.get());
+        }
+    }
+
+    /**
+     * Parse an expression, instrumented if ticks are armed
+     */
+    std::unique_ptr<Expression> parse_checked(const std::string& expression) {
+        auto expr = parse_expression(expression);
+        if (ticks_armed) {
+            instrument_ticks(expr.get());
+        }
+        return expr;
+    }
+
+    /**
+     * Register builtins that are bound to this wrapper
+     */
+    void install_builtins() {
+        // Manually register print function for WebAssembly
+        // This bypasses the static initializer issue
+        interpreter->builtin_functions["print"] = [this](const std::vector<Value>& args) -> Value {
+            return print_wasm(args, output);
+        };
+        // Checkpoint inserted by instrument_ticks()
+        interpreter->builtin_functions[ExecutionLimits::TICK_BUILTIN] = [this](const std::vector<Value>&) -> Value {
+            limits.tick();
+            if (yielder.due()) {
+                suspend();
+            }
+            return Value();
+        };
+        // Probes inserted by LineProfiler::instrument(); the profiler's own
+        // bookkeeping is not charged to the script
+        interpreter->builtin_functions[LineProfiler::PROBE_BUILTIN] = [this](const std::vector<Value>& args) -> Value {
+            MemoryAccount::Scope pause(nullptr);
+            line_profiler.probe(args.empty() ? -1 : static_cast<int>(args[0].as_number()));
+            return Value();
+        };
+        interpreter->builtin_functions[LineProfiler::ENTER_BUILTIN] = [this](const std::vector<Value>& args) -> Value {
+            MemoryAccount::Scope pause(nullptr);
+            int site = args.empty() ? -1 : static_cast<int>(args[0].as_number());
+            line_profiler.enter(site);
+            if (tracer.enabled()) {
+                if (const std::string* function = line_profiler.site_function(site)) {
+                    tracer.function_enter(*function);
+                }
+            }
+            return Value();
+        };
+        interpreter->builtin_functions[LineProfiler::LEAVE_BUILTIN] = [this](const std::vector<Value>& args) -> Value {
+            {
+                MemoryAccount::Scope pause(nullptr);
+                line_profiler.leave();
+                if (tracer.enabled()) {
+                    tracer.function_leave();
+                }
+            }
+            return args.empty() ? Value() : args[0];
+        };
+        profiler.apply(*interpreter);
+        builtins_bound = true;
+    }
+
+    // Copy-on-write, snapshots, fork() and reset() copy the core's state;
+    // fail the build rather than silently share it if that stops compiling
+    static_assert(std::is_copy_constructible_v<Interpreter> && std::is_copy_assignable_v<Interpreter>,
+                  "LaminaInterpreter copies Interpreter state");
+
+    /**
+     * Get the interpreter for a call that may mutate it
+     * Copies the state first if it is shared with a snapshot, and rebinds
+     * instance-bound builtins after adopting state from elsewhere
+     */
+    Interpreter& writable() {
+        pristine = false;
+        clean = false;
+        if (interpreter.use_count() > 1) {
+            // The copy holds the shared state, not anything the script
+            // allocated, so it is not charged to the script
+            MemoryAccount::Scope pause(nullptr);
+            interpreter = std::make_shared<Interpreter>(*interpreter);
+            builtins_bound = false;
+        }
+        if (!builtins_bound) {
+            install_builtins();
+        }
+        return *interpreter;
+    }
+
+    /**
+     * Whether evaluating an expression leaves the state it runs in as is
+     * Holds for literals, variables and operators, and for calls of
+     * builtins other than print and the internal ones. Only meaningful for
+     * a clean state, where no user function can share a builtin's name and
+     * no builtin is bound to a wrapper or profiled
+     */
+    bool reads_only(const Expression* expr) const {
+        if (dynamic_cast<const LiteralExpr*>(expr) || dynamic_cast<const IdentifierExpr*>(expr)) {
+            return true;
+        }
+        if (auto* unary = dynamic_cast<const UnaryExpr*>(expr)) {
+            return reads_only(unary->operand.get());
+        }
+        if (auto* binary = dynamic_cast<const BinaryExpr*>(expr)) {
+            return reads_only(binary->left.get()) && reads_only(binary->right.get());
+        }
+        if (auto* call = dynamic_cast<const CallExpr*>(expr)) {
+            if (call->callee == "print" || call->callee.rfind("__lamina_", 0) == 0
+                || interpreter->builtin_functions.count(call->callee) == 0) {
+                return false;
+            }
+            return std::all_of(call->args.begin(), call->args.end(), [this](const auto& arg) {
+                return reads_only(arg.get());
+            });
+        }
+        return false;
+    }
+
+    /**
+     * Get the interpreter for evaluating an expression
+     * Expressions that cannot change a clean state are evaluated against it
+     * even while it is shared, so calc() on a new or reset wrapper copies
+     * nothing; anything else goes through writable()
+     */
+    Interpreter& readable(const Expression* expr) {
+        if (clean && !profiler.wrapping() && reads_only(expr)) {
+            return *interpreter;
+        }
+        return writable();
+    }
+
+    /**
+     * Adopt a shared interpreter state
+     */
+    void adopt(std::shared_ptr<Interpreter> state) {
+        interpreter = std::move(state);
+        builtins_bound = false;
+        pristine = interpreter == baseline;
+        clean = interpreter == prototype_interpreter();
+    }
+
+    /**
+     * Create a wrapper that starts from a shared state, see fork()
+     */
+    explicit LaminaInterpreter(std::shared_ptr<Interpreter> state)
+        : interpreter(state), baseline(state), clean(state == prototype_interpreter()) {}
+
+    LaminaInterpreter(const LaminaInterpreter&) = delete;
+    LaminaInterpreter& operator=(const LaminaInterpreter&) = delete;
+
+public:
+    /**
+     * Start from the prototype state; nothing is copied until the first
+     * call that may modify it
+     */
+    LaminaInterpreter() : LaminaInterpreter(prototype_interpreter()) {}
+
+    ~LaminaInterpreter() {
+        memory->retire();
+    }
+
+    /**
+     * Execute Lamina code without throwing
+     * Failure details are read with errorKind(), errorMessage() and
+     * errorOffset(); nothing is formatted on success
+     * @param code The Lamina code to execute
+     * @return 0 on success, otherwise the ErrorKind of the failure
+     */
+    int executeStatus(const std::string& code) {
+        OutputBuffer::Flush flush(output);
+        return guarded("execute", [&](Stage& stage) {
+            // Reuse the cached AST for repeated sources, if caching is enabled
+            const std::unique_ptr<Statement>* stmt = parse_cache.find(code);
+            std::unique_ptr<Statement> parsed;
+            if (!stmt) {
+                if (line_profiler.enabled() || tracer.enabled()) {
+                    // Statement probes are only needed for line profiling;
+                    // tracing uses the function entry and exit probes
+                    std::vector<Token> tokens;
+                    parsed = parse_program(code, &tokens);
+                    // Builtins bound to this wrapper (print) only exist
+                    // in its own copy of the state
+                    const auto& builtins = writable().builtin_functions;
+                    line_profiler.instrument(parsed.get(), code, tokens, [&builtins](const std::string& name) {
+                        return builtins.count(name) > 0;
+                    }, line_profiler.enabled());
+                } else {
+                    parsed = parse_program(code);
+                }
+                if (ticks_armed) {
+                    instrument_ticks(parsed.get());
+                }
+                stmt = parse_cache.insert(code, parsed);
+                if (!stmt) {
+                    stmt = &parsed;
+                }
+            }
+
+            // Execute
+            stage = Stage::Evaluate;
+            TraceSpan span("phase", "eval");
+            writable().execute(*stmt);
+        });
+    }
+
+    /**
+     * Execute Lamina code, yielding to the event loop between slices
+     * Bound as a Promise-returning method in the JSPI build, where the call
+     * suspends once a slice of steps or milliseconds is used up and resumes
+     * in a later task. Slices end at the same checkpoints as limits, so
+     * code that does not loop or call functions runs in one go. The
+     * wrapper must not be used for anything else until the call settles
+     * @param code The Lamina code to execute
+     * @param sliceSteps Steps between yields, 0 for no step slice
+     * @param sliceMs Milliseconds between yields, 0 for no time slice
+     * @return 0 on success, otherwise the ErrorKind of the failure
+     */
+    int executeAsync(const std::string& code, double sliceSteps, double sliceMs) {
+        return executeSliced(code, sliceSteps, sliceMs, nullptr);
+    }
+
+    /**
+     * executeAsync() for embedders that suspend the call themselves
+     * @param suspend Called at every yield, see CooperativeYield::Suspend
+     */
+    int executeSliced(const std::string& code, double sliceSteps, double sliceMs,
+                      CooperativeYield::Suspend suspend) {
+        yielder.begin(sliceSteps, sliceMs, std::move(suspend));
+        if (yielder.active()) {
+            arm_ticks();
+        }
+        int status = executeStatus(code);
+        yielder.end();
+        return status;
+    }
+
+    /**
+     * Number of times the last executeAsync() call yielded
+     */
+    double lastYieldCount() const {
+        return static_cast<double>(yielder.yields());
+    }
+
+    /**
+     * Execute UTF-8 source bytes, see executeStatus()
+     * Takes bytes the caller already has in memory (the WASM heap), which
+     * saves decoding them into a JS string that embind would encode again;
+     * they are still copied once into the source string
+     * @param source UTF-8 source, need not be null-terminated
+     * @param length Length of the source in bytes
+     * @return 0 on success, otherwise the ErrorKind of the failure
+     */
+    int executeBytes(const char* source, size_t length) {
+        return executeStatus(std::string(source, length));
+    }
+
+    /**
+     * Append a chunk of UTF-8 source for finishSource()
+     * Chunks may split lines, tokens and multi-byte characters anywhere;
+     * the source is lexed once it is complete. Lets a caller stream a
+     * large script in without building it as one JS string first, though
+     * the whole source is held here until finishSource()
+     * @param chunk UTF-8 bytes
+     * @param length Length of the chunk in bytes
+     */
+    void appendSource(const char* chunk, size_t length) {
+        pending_source.append(chunk, length);
+    }
+
+    /**
+     * Execute the source received by appendSource() and start over
+     * @return 0 on success, otherwise the ErrorKind of the failure
+     */
+    int finishSource() {
+        std::string source;
+        source.swap(pending_source);
+        return executeStatus(source);
+    }
+
+    /**
+     * Drop the source received by appendSource() without running it
+     */
+    void discardSource() {
+        std::string().swap(pending_source);
+    }
+
+    /**
+     * Evaluate a Lamina expression without throwing
+     * On success the value is read with resultString() or resultValue()
+     * @param expression The Lamina expression to evaluate
+     * @return 0 on success, otherwise the ErrorKind of the failure
+     */
+    int evalStatus(const std::string& expression) {
+        OutputBuffer::Flush flush(output);
+        return guarded("eval", [&](Stage& stage) {
+            auto expr = parse_checked(expression);
+            stage = Stage::Evaluate;
+            TraceSpan span("phase", "eval");
+            last_result = readable(expr.get()).eval(expr.get());
+        });
+    }
+
+    /**
+     * Take the result of the last successful evalStatus()
+     * The wrapper lets go of it, so a large result is not kept alive until
+     * the next call; reading it twice yields null the second time
+     */
+    Value take_result() {
+        Value result = std::move(last_result);
+        last_result = Value();
+        return result;
+    }
+
+    /**
+     * Take the result of the last successful evalStatus() as a string
+     */
+    std::string resultString() {
+        return take_result().to_string();
+    }
+
+    /**
+     * ErrorKind of the last failure
+     */
+    int errorKind() const {
+        return static_cast<int>(diagnostic.kind);
+    }
+
+    /**
+     * Message of the last failure
+     */
+    std::string errorMessage() const {
+        return diagnostic.message;
+    }
+
+    /**
+     * Source offset of the last failure, or -1 if unknown
+     */
+    int errorOffset() const {
+        return diagnostic.offset;
+    }
+
+    /**
+     * Execute Lamina code and return the result
+     * @param code The Lamina code to execute
+     * @return Result as a string
+     */
+    std::string execute(const std::string& code) {
+        if (executeStatus(code) == 0) {
+            return "";
+        }
+        std::string error_msg = format_error("std::exception: ");
+        report_error(error_msg);
+        return error_msg;
+    }
+
+    /**
+     * Evaluate a Lamina expression and return the result
+     * @param expression The Lamina expression to evaluate
+     * @return Result as a string
+     */
+    std::string eval(const std::string& expression) {
+        if (evalStatus(expression) == 0) {
+            return resultString();
+        }
+        return format_error("Error: ");
+    }
+
+    /**
+     * Evaluate a Lamina expression for evalValue()
+     * Fails like evalStatus(), so the diagnostics are set as well
+     * @param expression The Lamina expression to evaluate
+     * @param value Receives the result on success
+     * @param error Receives the error message on failure, as eval() gives it
+     * @return Whether evaluation succeeded
+     */
+    bool evaluate_value(const std::string& expression, Value& value, std::string& error) {
+        if (evalStatus(expression) != 0) {
+            error = format_error("Error: ");
+            return false;
+        }
+        value = take_result();
+        return true;
+    }
+
+    /**
+     * Compile a Lamina expression for repeated evaluation
+     * Lexing and parsing happen once here; evaluate() only walks the AST.
+     * Parsing runs under the limits and quota like any other call
+     * @param expression The Lamina expression to compile
+     * @return Handle of the compiled expression, or -1 on error (see
+     *         getLastError(), and errorKind() for its ErrorKind)
+     */
+    int compile(const std::string& expression) {
+        int handle = -1;
+        int status = guarded("compile", [&](Stage&) {
+            auto expr = parse_checked(expression);
+            handle = next_handle++;
+            compiled_expressions[handle] = std::move(expr);
+        });
+        if (status != 0) {
+            last_error = format_error("Error: ");
+            return -1;
+        }
+        return handle;
+    }
+
+    /**
+     * Evaluate a compiled expression against the current variables
+     * without throwing, see evalStatus()
+     * @param handle Handle returned by compile()
+     * @return 0 on success, otherwise the ErrorKind of the failure
+     */
+    int evaluateStatus(int handle) {
+        OutputBuffer::Flush flush(output);
+        auto it = compiled_expressions.find(handle);
+        if (it == compiled_expressions.end()) {
+            return diagnostic.fail(ErrorKind::Native, "Invalid expression handle");
+        }
+        const Expression* expr = it->second.get();
+        return guarded("evaluate", [&](Stage& stage) {
+            stage = Stage::Evaluate;
+            TraceSpan span("phase", "eval");
+            last_result = readable(expr).eval(expr);
+        });
+    }
+
+    /**
+     * Evaluate a compiled expression against the current variables
+     * @param handle Handle returned by compile()
+     * @return Result as a string
+     */
+    std::string evaluate(int handle) {
+        if (evaluateStatus(handle) == 0) {
+            return resultString();
+        }
+        return format_error("Error: ");
+    }
+
+    /**
+     * Evaluate a compiled expression once per row over columns of inputs
+     * Column i is bound to the variable named by the packed names buffer.
+     * Purely numeric expressions run on the float64 NumericKernel without
+     * touching interpreter variables; anything else, or a kernel run that
+     * hits an input the interpreter rejects, falls back to binding each
+     * row's values in a scope of its own and evaluating the AST
+     * @param handle Handle returned by compile()
+     * @param names Packed UTF-8 column names
+     * @param nameOffsets columnCount + 1 offsets into names
+     * @param columns columnCount columns of rows float64 values each
+     * @param columnCount Number of columns
+     * @param rows Number of rows
+     * @param results rows float64 outputs
+     * @return 1 if the float64 kernel was used, 0 for the generic path, or
+     *         minus the ErrorKind of the failure (see errorMessage())
+     */
+    int evaluateColumns(int handle, const char* names, const uint32_t* nameOffsets, const double* const* columns,
+                        size_t columnCount, size_t rows, double* results) {
+        OutputBuffer::Flush flush(output);
+        auto it = compiled_expressions.find(handle);
+        if (it == compiled_expressions.end()) {
+            return -diagnostic.fail(ErrorKind::Native, "Invalid expression handle");
+        }
+
+        int path = 0;
+        int status = guarded("evaluateColumns", [&](Stage& stage) {
+            stage = Stage::Evaluate;
+            std::vector<std::string> column_names;
+            for (size_t i = 0; i < columnCount; ++i) {
+                column_names.emplace_back(names + nameOffsets[i], nameOffsets[i + 1] - nameOffsets[i]);
+            }
+
+            auto kernel = NumericKernel::compile(it->second.get(), column_names,
+                [this](const std::string& name, double& constant) {
+                    try {
+                        Value value = interpreter->get_variable(name);
+                        if (!value.is_numeric()) {
+                            return false;
+                        }
+                        constant = value.as_number();
+                        return true;
+                    } catch (...) {
+                        return false;
+                    }
+                },
+                [this](const std::string& name) {
+                    return interpreter->functions.count(name) == 0
+                        && interpreter->builtin_functions.count(name) > 0;
+                });
+            if (kernel && kernel->run(columns, rows, results)) {
+                path = 1;
+                return;
+            }
+
+            // Columns are bound in a scope popped afterwards, so none is left
+            // behind as a global or overwrites one. An expression that only
+            // reads gets the clean state back, keeping later calls on the
+            // readable() fast path
+            const Expression* expr = it->second.get();
+            std::shared_ptr<Interpreter> before = interpreter;
+            bool keep_clean = clean && !profiler.wrapping() && reads_only(expr);
+            {
+                Interpreter& state = writable();
+                state.push_scope();
+                struct PopScope {
+                    Interpreter& state;
+                    ~PopScope() { state.pop_scope(); }
+                } pop{state};
+                for (size_t row = 0; row < rows; ++row) {
+                    for (size_t i = 0; i < columnCount; ++i) {
+                        state.set_variable(column_names[i], Value(columns[i][row]));
+                    }
+                    results[row] = state.eval(expr).as_number();
+                }
+            }
+            if (keep_clean) {
+                adopt(std::move(before));
+            }
+        });
+        return status == 0 ? path : -status;
+    }
+
+    /**
+     * Release a compiled expression
+     * @param handle Handle returned by compile()
+     */
+    void release(int handle) {
+        compiled_expressions.erase(handle);
+    }
+
+    /**
+     * Enable or disable output capture
+     * While capturing, print() output accumulates in an in-WASM buffer that
+     * is drained with takeOutput() or outputView() + clearOutput()
+     * @param enabled Whether to capture output
+     */
+    void setOutputCapture(bool enabled) {
+        output.set_capture(enabled);
+    }
+
+    /**
+     * Take the captured output as a string and clear the buffer
+     */
+    std::string takeOutput() {
+        return output.take();
+    }
+
+    /**
+     * Captured output, see outputView()
+     */
+    const std::string& captured_output() const {
+        return output.contents();
+    }
+
+    /**
+     * Clear the captured output
+     */
+    void clearOutput() {
+        output.clear();
+    }
+
+    /**
+     * Limit the work done by each execute()/eval() call
+     * A call that runs out of steps or time is aborted with a Limit error;
+     * the interpreter stays usable. Steps are counted per block entered,
+     * i.e. per loop iteration and per user function call; code is only
+     * instrumented to count them from the first call that sets a limit
+     * @param maxSteps Maximum number of steps per call, 0 for unlimited
+     * @param timeoutMs Maximum wall-clock time per call, 0 for unlimited
+     */
+    void setLimits(double maxSteps, double timeoutMs) {
+        limits.configure(maxSteps, timeoutMs);
+        if (limits.active()) {
+            arm_ticks();
+        }
+    }
+
+    /**
+     * Number of steps taken by the last execute()/eval() call
+     */
+    double lastStepCount() const {
+        return static_cast<double>(limits.steps());
+    }
+
+    /**
+     * Cap the heap charged to this interpreter
+     * Everything allocated while running Lamina code (values, bigints,
+     * arrays, strings, parsed programs) is charged until it is freed. An
+     * allocation that would exceed the quota fails the call with a Memory
+     * error; the interpreter stays usable
+     * @param bytes Quota in bytes, 0 for unlimited
+     */
+    void setMemoryQuota(double bytes) {
+        memory->set_quota(bytes > 0 ? static_cast<size_t>(bytes) : 0);
+    }
+
+    /**
+     * Heap usage charged to this interpreter, see memoryUsage()
+     */
+    const MemoryAccount& memory_account() const {
+        return *memory;
+    }
+
+    /**
+     * Turn builtin profiling on or off
+     * While on, every builtin call is counted and timed; while off the
+     * original builtins are in place and nothing is recorded
+     * @param enabled Whether to profile builtin calls
+     */
+    void setProfiling(bool enabled) {
+        profiler.set_enabled(enabled);
+        if (profiler.needs_apply(*interpreter)) {
+            profiler.apply(writable());
+        }
+    }
+
+    /**
+     * Builtins that were called, most expensive first, see getProfile()
+     */
+    std::vector<std::pair<const std::string*, const BuiltinProfiler::Entry*>> profile_rows() const {
+        std::vector<std::pair<const std::string*, const BuiltinProfiler::Entry*>> rows;
+        for (const auto& [name, entry] : profiler.results()) {
+            if (entry.calls > 0) {
+                rows.emplace_back(&name, &entry);
+            }
+        }
+        std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) {
+            return a.second->self_ms > b.second->self_ms;
+        });
+        return rows;
+    }
+
+    /**
+     * Clear builtin call statistics
+     */
+    void resetProfile() {
+        profiler.reset();
+    }
+
+    /**
+     * Turn line profiling on or off
+     * Programs parsed by execute() while on are instrumented with probes,
+     * so toggling drops the parse cache. Functions defined while on keep
+     * their probes, which do nothing while off
+     * @param enabled Whether to profile lines
+     */
+    void setLineProfiling(bool enabled) {
+        if (enabled != line_profiler.enabled()) {
+            line_profiler.set_enabled(enabled);
+            parse_cache.clear();
+        }
+    }
+
+    /**
+     * Lines that ran, most expensive first, see getLineProfile()
+     */
+    std::vector<std::pair<const LineProfiler::Site*, const LineProfiler::LineStats*>> line_rows() const {
+        const auto& sites = line_profiler.site_table();
+        std::vector<std::pair<const LineProfiler::Site*, const LineProfiler::LineStats*>> rows;
+        for (const auto& [site, stats] : line_profiler.line_stats()) {
+            rows.emplace_back(&sites[site], &stats);
+        }
+        std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) {
+            return a.second->time_ms > b.second->time_ms;
+        });
+        return rows;
+    }
+
+    /**
+     * Get time per call stack in collapsed-stack format
+     * Feed to flamegraph.pl, speedscope or similar; values are microseconds
+     */
+    std::string getCollapsedStacks() const {
+        return line_profiler.collapsed();
+    }
+
+    /**
+     * Clear line profiling statistics
+     */
+    void resetLineProfile() {
+        line_profiler.reset();
+    }
+
+    /**
+     * Start recording a trace of execute() and eval() calls
+     * Records call spans, lex/parse/eval phases, calls of user functions
+     * defined from now on, and builtin calls slower than slowBuiltinMs.
+     * Restarting discards the previous trace
+     * @param capacity Number of events kept in the ring buffer
+     * @param slowBuiltinMs Threshold for recording a builtin call
+     */
+    void startTrace(size_t capacity, double slowBuiltinMs) {
+        if (!tracer.enabled()) {
+            // Cached programs lack the function entry/exit probes
+            parse_cache.clear();
+        }
+        tracer.start(capacity);
+        profiler.set_slow_hook(slowBuiltinMs, [this](const std::string& name, double start, double) {
+            tracer.complete("builtin", name, start);
+        });
+        if (profiler.needs_apply(*interpreter)) {
+            profiler.apply(writable());
+        }
+    }
+
+    /**
+     * Stop recording; the trace is kept until exported or cleared
+     */
+    void stopTrace() {
+        if (!tracer.enabled()) {
+            return;
+        }
+        tracer.stop();
+        parse_cache.clear();
+        profiler.set_slow_hook(0, nullptr);
+        if (profiler.needs_apply(*interpreter)) {
+            profiler.apply(writable());
+        }
+    }
+
+    /**
+     * Export the trace as Chrome Trace Event JSON
+     * Load it in Perfetto or chrome://tracing; timestamps are
+     * performance.now() in microseconds
+     */
+    std::string exportTrace() const {
+        return tracer.to_json();
+    }
+
+    /**
+     * Discard recorded trace events
+     */
+    void clearTrace() {
+        tracer.clear();
+    }
+
+    /**
+     * Enable the parse cache used by execute()
+     * Repeated sources then skip tokenizing and parsing entirely
+     * @param maxEntries Maximum number of cached programs
+     * @param maxBytes Approximate memory budget of the cache in bytes
+     */
+    void enableParseCache(size_t maxEntries, size_t maxBytes) {
+        parse_cache.configure(maxEntries, maxBytes);
+    }
+
+    /**
+     * Disable the parse cache and drop all cached programs
+     */
+    void disableParseCache() {
+        parse_cache.configure(0, 0);
+    }
+
+    /**
+     * Parse cache used by execute(), see getParseCacheStats()
+     */
+    const ParseCache& program_cache() const {
+        return parse_cache;
+    }
+
+    /**
+     * Get the message of the last compile error
+     */
+    std::string getLastError() const {
+        return last_error;
+    }
+
+    /**
+     * Evaluate a batch of expressions with a single call
+     * Expression i occupies bytes [offsets[i], offsets[i + 1]) of the packed
+     * UTF-8 source buffer. The result is reused by the next call
+     * @param source Packed expression bytes
+     * @param offsets count + 1 offsets into source
+     * @param count Number of expressions
+     */
+    const BatchResult& evalBatch(const char* source, const uint32_t* offsets, size_t count) {
+        OutputBuffer::Flush flush(output);
+        batch.data.clear();
+        batch.offsets.assign(1, 0);
+        batch.errors.assign(count, 0);
+
+        for (size_t i = 0; i < count; ++i) {
+            // Guarded per item so every item gets the full step, time and
+            // quota budget
+            std::string expression(source + offsets[i], offsets[i + 1] - offsets[i]);
+            int status = guarded("evalBatch", [&](Stage& stage) {
+                auto expr = parse_checked(expression);
+                stage = Stage::Evaluate;
+                batch.data += readable(expr.get()).eval(expr.get()).to_string();
+            });
+            if (status != 0) {
+                batch.data += format_error("Error: ");
+                batch.errors[i] = static_cast<uint8_t>(status);
+            }
+            batch.offsets.push_back(static_cast<uint32_t>(batch.data.size()));
+        }
+        return batch;
+    }
+
+    /**
+     * Set a variable in the interpreter
+     * @param name Variable name
+     * @param value Variable value (as string, will be evaluated)
+     */
+    void setVariable(const std::string& name, double value) {
+        try {
+            writable().set_variable(name, Value(value));
+        } catch (const std::exception& e) {
+            // Handle error silently or throw
+        }
+    }
+
+    /**
+     * Set a string variable in the interpreter
+     * @param name Variable name
+     * @param value Variable value as string
+     */
+    void setStringVariable(const std::string& name, const std::string& value) {
+        try {
+            writable().set_variable(name, Value(value));
+        } catch (const std::exception& e) {
+            // Handle error silently or throw
+        }
+    }
+
+    /**
+     * Bind many numeric variables at once
+     * Names use the packed layout of evalBatch()
+     * @param names Packed UTF-8 variable names
+     * @param nameOffsets count + 1 offsets into names
+     * @param values count float64 values
+     * @param count Number of variables
+     */
+    void bindVariables(const char* names, const uint32_t* nameOffsets, const double* values, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            std::string name(names + nameOffsets[i], nameOffsets[i + 1] - nameOffsets[i]);
+            writable().set_variable(name, Value(values[i]));
+        }
+    }
+
+    /**
+     * Bind a numeric array variable from a typed array
+     * @param name Variable name
+     * @param data First element
+     * @param length Number of elements
+     * @param isInt True for int32 elements, false for float64 elements
+     */
+    void bindArray(const std::string& name, const void* data, size_t length, bool isInt) {
+        std::vector<Value> items;
+        items.reserve(length);
+        if (isInt) {
+            const int32_t* elements = static_cast<const int32_t*>(data);
+            for (size_t i = 0; i < length; ++i) {
+                items.emplace_back(static_cast<int>(elements[i]));
+            }
+        } else {
+            const double* elements = static_cast<const double*>(data);
+            for (size_t i = 0; i < length; ++i) {
+                items.emplace_back(elements[i]);
+            }
+        }
+        writable().set_variable(name, Value(items));
+    }
+
+    /**
+     * Get a variable from the interpreter
+     * @param name Variable name
+     * @return Variable value as string
+     */
+    std::string getVariable(const std::string& name) {
+        try {
+            Value val = interpreter->get_variable(name);
+            return val.to_string();
+        } catch (const std::exception& e) {
+            return std::string("Error: ") + e.what();
+        }
+    }
+
+    /**
+     * Look up a variable for getVariableValue()
+     * @param name Variable name
+     * @param value Receives the value if found
+     * @param error Receives the error message otherwise
+     * @return Whether the variable was found
+     */
+    bool variable_value(const std::string& name, Value& value, std::string& error) const {
+        try {
+            value = interpreter->get_variable(name);
+            return true;
+        } catch (const std::exception& e) {
+            error = std::string("Error: ") + e.what();
+            return false;
+        }
+    }
+
+    /**
+     * Reset the interpreter state
+     * Restores the warm state captured at construction instead of building
+     * a new Interpreter and registering every builtin again. Nothing is
+     * done if no call could have changed the state since; a private copy
+     * is overwritten in place, reusing its tables, so the next call that
+     * changes the state does not copy again
+     */
+    void reset() {
+        last_result = Value();
+        if (pristine) {
+            return;
+        }
+        if (interpreter.use_count() > 1) {
+            adopt(baseline);
+            return;
+        }
+        // Not charged to the script, like the copy made by writable()
+        MemoryAccount::Scope pause(nullptr);
+        *interpreter = *baseline;
+        builtins_bound = false;
+        pristine = true;
+        clean = baseline == prototype_interpreter();
+    }
+
+    /**
+     * Return to the state of a new wrapper, for reuse by InterpreterPool
+     * Besides reset(), drops everything configured on this wrapper: limits,
+     * memory quota, output capture, parse cache, compiled expressions,
+     * pending source, profiling and tracing
+     */
+    void recycle() {
+        limits.configure(0, 0);
+        ticks_armed = false;
+        memory->set_quota(0);
+        output.set_capture(false);
+        output.clear();
+        parse_cache.configure(0, 0);
+        compiled_expressions.clear();
+        last_error.clear();
+        std::string().swap(pending_source);
+        // Profiler wrappers in the state itself are dropped by reset()
+        profiler.set_enabled(false);
+        profiler.set_slow_hook(0, nullptr);
+        profiler.reset();
+        line_profiler.set_enabled(false);
+        line_profiler.reset();
+        tracer.stop();
+        tracer.clear();
+        reset();
+    }
+
+    /**
+     * Capture the current interpreter state
+     * Globals, user functions and builtin tables are shared copy-on-write,
+     * so taking a snapshot is O(1); the next mutation pays for the copy
+     */
+    InterpreterSnapshot snapshot() const {
+        return InterpreterSnapshot{interpreter};
+    }
+
+    /**
+     * Create an isolated interpreter starting from the current state
+     * Globals, user functions and builtins are shared copy-on-write, so a
+     * fork costs nothing until it first mutates its state. reset() on the
+     * fork returns to the state it was forked from
+     * @return The new interpreter, owned by JavaScript
+     */
+    std::unique_ptr<LaminaInterpreter> fork() const {
+        std::unique_ptr<LaminaInterpreter> forked(new LaminaInterpreter(interpreter));
+        forked->memory->set_quota(memory->quota());
+        return forked;
+    }
+
+    /**
+     * Restore a state captured by snapshot()
+     * @param snapshot Snapshot of this or another interpreter
+     */
+    void restore(const InterpreterSnapshot& snapshot) {
+        adopt(snapshot.state);
+    }
+
+    /**
+     * Get version information
+     */
+    static std::string getVersion() {
+        return "Lamina.js 1.0.0";
+    }
+};
+
+/**
+ * Pool of warm interpreters backing the standalone entry points
+ * New interpreters are forked from a prototype instead of registering every
+ * builtin again, and returned interpreters are recycled: reset to their
+ * baseline, with any settings made while leased cleared
+ */
+class InterpreterPool {
+public:
+    /**
+     * Interpreter borrowed from the pool, returned when the lease ends
+     */
+    class Lease {
+    public:
+        Lease(InterpreterPool& pool, std::unique_ptr<LaminaInterpreter> interp)
+            : pool(pool), interp(std::move(interp)) {}
+        ~Lease() { pool.give_back(std::move(interp)); }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        LaminaInterpreter* operator->() { return interp.get(); }
+        LaminaInterpreter& operator*() { return *interp; }
+
+    private:
+        InterpreterPool& pool;
+        std::unique_ptr<LaminaInterpreter> interp;
+    };
+
+    Lease acquire() {
+        ++acquired;
+        if (!idle.empty()) {
+            auto interp = std::move(idle.back());
+            idle.pop_back();
+            return Lease(*this, std::move(interp));
+        }
+        ++created;
+        return Lease(*this, prototype.fork());
+    }
+
+    /**
+     * Set the maximum number of idle interpreters kept warm
+     */
+    void set_capacity(size_t size) {
+        capacity = size;
+        if (idle.size() > capacity) {
+            idle.resize(capacity);
+        }
+    }
+
+    struct Stats {
+        size_t capacity;
+        size_t idle;
+        uint64_t created;
+        uint64_t acquired;
+    };
+
+    Stats stats() const {
+        return Stats{capacity, idle.size(), created, acquired};
+    }
+
+private:
+    LaminaInterpreter prototype;
+    std::vector<std::unique_ptr<LaminaInterpreter>> idle;
+    size_t capacity = 4;
+    uint64_t created = 0;
+    uint64_t acquired = 0;
+
+    void give_back(std::unique_ptr<LaminaInterpreter> interp) {
+        if (idle.size() >= capacity) {
+            return;
+        }
+        interp->recycle();
+        idle.push_back(std::move(interp));
+    }
+};
+
+/**
+ * Pool for the calling thread; interpreters are not shared across threads
+ */
+inline InterpreterPool& interpreter_pool() {
+    static thread_local InterpreterPool pool;
+    return pool;
+}
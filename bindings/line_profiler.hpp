@@ -0,0 +1,414 @@
+#pragma once
+
+#include "../Lamina/interpreter/ast.hpp"
+#include "../Lamina/interpreter/lexer.hpp"
+#include "clock.hpp"
+#include "memory_accounting.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Line-level profiler for Lamina programs
+ *
+ * The parser keeps no source positions, so lines are recovered from the
+ * token stream: statement_starts() finds the first token of every
+ * statement and instrument() pairs them with the statements of the AST in
+ * source order. Every statement is then preceded by a call to the probe
+ * builtin. Time and allocations between two probes are charged to the
+ * line of the first one, the way a tracing line profiler attributes work;
+ * WASM has no signals to sample with.
+ *
+ * Lines are only meaningful within the source they came from, so every
+ * distinct source text instrumented gets a source id of its own, numbered
+ * from 1 in the order they are first seen, and sites are keyed by source
+ * as well as by function and line. Sources are told apart by a hash of
+ * their text, so running the same code again, parsed or cached, adds to
+ * the same sites.
+ *
+ * User function bodies start with an enter call and calls to user
+ * functions are wrapped in a leave call, which maintains the call stack
+ * used for collapsed-stack (flamegraph) output.
+ */
+class LineProfiler {
+public:
+    static constexpr const char* PROBE_BUILTIN = "__lamina_probe__";
+    static constexpr const char* ENTER_BUILTIN = "__lamina_enter__";
+    static constexpr const char* LEAVE_BUILTIN = "__lamina_leave__";
+    static constexpr const char* ROOT_FRAME = "<main>";
+
+    using IsBuiltin = std::function<bool(const std::string&)>;
+
+    // A line of one source within a function; "" is top-level code
+    struct Site {
+        int source;
+        int line;
+        std::string function;
+    };
+
+    struct LineStats {
+        uint64_t hits = 0;
+        double time_ms = 0;
+        uint64_t allocations = 0;
+    };
+
+    bool enabled() const {
+        return active;
+    }
+
+    void set_enabled(bool enabled) {
+        active = enabled;
+    }
+
+    /**
+     * Insert probes into a freshly parsed program
+     * @param program Parsed program
+     * @param source Source text the program was parsed from
+     * @param tokens Tokens the program was parsed from
+     * @param is_builtin Tells user function calls from builtin calls
+     * @param statements False to only instrument function entry and exit
+     * @return Source id of the program's sites
+     */
+    int instrument(Statement* program, const std::string& source, const std::vector<Token>& tokens,
+                   const IsBuiltin& is_builtin, bool statements = true) {
+        auto [it, added] = source_ids.emplace(std::hash<std::string>{}(source), 0);
+        if (added) {
+            it->second = static_cast<int>(source_ids.size());
+        }
+        Instrumenter instrumenter{*this, it->second, statement_starts(tokens), 0, is_builtin, statements};
+        instrumenter.statement(program, "", 0);
+        return instrumenter.source;
+    }
+
+    /**
+     * Start a profiled call
+     * @param account Account whose allocation count is attributed to lines
+     */
+    void begin(const MemoryAccount* account) {
+        memory = account;
+        stack.assign(1, Frame{"", 0, -1});
+        path = ROOT_FRAME;
+        current_site = -1;
+        last_time = now_ms();
+        last_allocations = memory->allocations();
+    }
+
+    /**
+     * Charge the tail of a profiled call to the last line run
+     */
+    void finish() {
+        if (memory) {
+            charge();
+            current_site = -1;
+            memory = nullptr;
+        }
+    }
+
+    /**
+     * A statement is about to run
+     * Probes outside a profiled call (e.g. evaluate()) are ignored
+     */
+    void probe(int site) {
+        if (!memory || !valid(site)) {
+            return;
+        }
+        charge();
+        current_site = site;
+        ++stats[site].hits;
+
+        // Unwind calls whose leave was not instrumented
+        const std::string& function = sites[site].function;
+        while (stack.size() > 1 && stack.back().function != function) {
+            pop();
+        }
+    }
+
+    /**
+     * A user function body is about to run
+     */
+    void enter(int site) {
+        if (!memory || !valid(site)) {
+            return;
+        }
+        charge();
+        stack.push_back(Frame{sites[site].function, path.size(), current_site});
+        path += ';';
+        path += sites[site].function;
+        current_site = site;
+    }
+
+    /**
+     * A user function call returned
+     */
+    void leave() {
+        if (!memory) {
+            return;
+        }
+        charge();
+        if (stack.size() > 1) {
+            pop();
+        }
+    }
+
+    /**
+     * Name of the function a site belongs to, or nullptr for a bad site
+     */
+    const std::string* site_function(int site) const {
+        return valid(site) ? &sites[site].function : nullptr;
+    }
+
+    const std::vector<Site>& site_table() const {
+        return sites;
+    }
+
+    const std::unordered_map<int, LineStats>& line_stats() const {
+        return stats;
+    }
+
+    /**
+     * Time per stack in collapsed-stack format
+     * One "frame;frame;leaf:line microseconds" entry per line
+     */
+    std::string collapsed() const {
+        std::string result;
+        for (const auto& [stack_key, ms] : stacks) {
+            auto us = static_cast<uint64_t>(ms * 1000 + 0.5);
+            if (us == 0) {
+                continue;
+            }
+            result += stack_key;
+            result += ' ';
+            result += std::to_string(us);
+            result += '\n';
+        }
+        return result;
+    }
+
+    /**
+     * Zero all statistics
+     * Sites are kept because instrumented code refers to them
+     */
+    void reset() {
+        stats.clear();
+        stacks.clear();
+    }
+
+private:
+    struct Start {
+        int line;
+        std::string text;
+    };
+
+    struct Frame {
+        std::string function;
+        size_t path_length;  // Length of path before this frame was pushed
+        int caller_site;
+    };
+
+    /**
+     * Walks a program, assigning statements their lines and adding probes
+     */
+    struct Instrumenter {
+        LineProfiler& profiler;
+        int source;
+        std::vector<Start> starts;
+        size_t cursor;
+        const IsBuiltin& is_builtin;
+        bool statements;
+
+        /**
+         * @param line Line of stmt itself, assigned by the enclosing block
+         */
+        void statement(Statement* stmt, const std::string& function, int line) {
+            if (auto* block = dynamic_cast<BlockStmt*>(stmt)) {
+                std::vector<std::unique_ptr<Statement>> probed;
+                probed.reserve(block->statements.size() * 2);
+                for (auto& child : block->statements) {
+                    int child_line = line;
+                    if (!dynamic_cast<BlockStmt*>(child.get())) {
+                        child_line = line_of(child.get());
+                        if (statements) {
+                            probed.push_back(call_stmt(PROBE_BUILTIN, profiler.intern(source, child_line, function)));
+                        }
+                    }
+                    statement(child.get(), function, child_line);
+                    probed.push_back(std::move(child));
+                }
+                block->statements = std::move(probed);
+            } else if (auto* branch = dynamic_cast<IfStmt*>(stmt)) {
+                calls(branch->condition);
+                statement(branch->thenBlock.get(), function, line);
+                statement(branch->elseBlock.get(), function, line);
+            } else if (auto* loop = dynamic_cast<WhileStmt*>(stmt)) {
+                calls(loop->condition);
+                statement(loop->body.get(), function, line);
+            } else if (auto* func = dynamic_cast<FuncDefStmt*>(stmt)) {
+                if (func->body) {
+                    statement(func->body.get(), func->name, line);
+                    int site = profiler.intern(source, line, func->name);
+                    auto& body = func->body->statements;
+                    body.insert(body.begin(), call_stmt(ENTER_BUILTIN, site));
+                }
+            } else if (auto* expr = dynamic_cast<ExprStmt*>(stmt)) {
+                calls(expr->expr);
+            } else if (auto* ret = dynamic_cast<ReturnStmt*>(stmt)) {
+                calls(ret->expr);
+            } else if (auto* decl = dynamic_cast<VarDeclStmt*>(stmt)) {
+                calls(decl->expr);
+            } else if (auto* assign = dynamic_cast<AssignStmt*>(stmt)) {
+                calls(assign->expr);
+            }
+        }
+
+        /**
+         * Wrap calls to user functions in a leave call
+         */
+        void calls(std::unique_ptr<Expression>& expr) {
+            if (!expr) {
+                return;
+            }
+            if (auto* binary = dynamic_cast<BinaryExpr*>(expr.get())) {
+                calls(binary->left);
+                calls(binary->right);
+            } else if (auto* unary = dynamic_cast<UnaryExpr*>(expr.get())) {
+                calls(unary->operand);
+            } else if (auto* call = dynamic_cast<CallExpr*>(expr.get())) {
+                for (auto& arg : call->args) {
+                    calls(arg);
+                }
+                if (call->callee.rfind("__lamina_", 0) != 0 && !is_builtin(call->callee)) {
+                    std::vector<std::unique_ptr<Expression>> args;
+                    args.push_back(std::move(expr));
+                    expr = std::make_unique<CallExpr>(LEAVE_BUILTIN, std::move(args));
+                }
+            }
+        }
+
+        /**
+         * Line of the next statement, resynchronising on its keyword
+         */
+        int line_of(Statement* stmt) {
+            const char* keyword = nullptr;
+            if (dynamic_cast<IfStmt*>(stmt)) {
+                keyword = "if";
+            } else if (dynamic_cast<WhileStmt*>(stmt)) {
+                keyword = "while";
+            } else if (dynamic_cast<FuncDefStmt*>(stmt)) {
+                keyword = "func";
+            } else if (dynamic_cast<ReturnStmt*>(stmt)) {
+                keyword = "return";
+            } else if (dynamic_cast<VarDeclStmt*>(stmt)) {
+                keyword = "var";
+            }
+
+            size_t index = cursor;
+            if (keyword) {
+                while (index < starts.size() && starts[index].text != keyword) {
+                    ++index;
+                }
+                if (index == starts.size()) {
+                    index = cursor;
+                }
+            }
+            if (index >= starts.size()) {
+                return starts.empty() ? 0 : starts.back().line;
+            }
+            cursor = index + 1;
+            return starts[index].line;
+        }
+
+        static std::unique_ptr<Statement> call_stmt(const char* builtin, int site) {
+            std::vector<std::unique_ptr<Expression>> args;
+            args.push_back(std::make_unique<LiteralExpr>(std::to_string(site), Value::Type::Int));
+            return std::make_unique<ExprStmt>(std::make_unique<CallExpr>(builtin, std::move(args)));
+        }
+    };
+
+    bool active = false;
+    const MemoryAccount* memory = nullptr;
+
+    std::unordered_map<size_t, int> source_ids;
+    std::vector<Site> sites;
+    std::unordered_map<std::string, int> site_index;
+
+    std::unordered_map<int, LineStats> stats;
+    std::unordered_map<std::string, double> stacks;
+
+    std::vector<Frame> stack;
+    std::string path;
+    int current_site = -1;
+    double last_time = 0;
+    uint64_t last_allocations = 0;
+
+    /**
+     * First token of every statement, in source order
+     * A statement starts at the beginning of the program and after a
+     * top-level ';', '{', '}' or 'else'; braces and 'else' never start one
+     */
+    static std::vector<Start> statement_starts(const std::vector<Token>& tokens) {
+        std::vector<Start> starts;
+        bool at_start = true;
+        int depth = 0;
+        for (const auto& token : tokens) {
+            if (token.type == TokenType::EndOfFile) {
+                break;
+            }
+            // Punctuation inside string literals does not count
+            bool literal = token.type == TokenType::String;
+            auto is = [&](const char* text) { return !literal && token.text == text; };
+
+            bool separator = is(";") || is("{") || is("}") || is("else");
+            if (at_start && !separator) {
+                starts.push_back(Start{token.line, token.text});
+                at_start = false;
+            }
+            if (is("(") || is("[")) {
+                ++depth;
+            } else if ((is(")") || is("]")) && depth > 0) {
+                --depth;
+            } else if (separator && depth == 0) {
+                at_start = true;
+            }
+        }
+        return starts;
+    }
+
+    bool valid(int site) const {
+        return site >= 0 && static_cast<size_t>(site) < sites.size();
+    }
+
+    int intern(int source, int line, const std::string& function) {
+        std::string key = std::to_string(source) + '\n' + function + '\n' + std::to_string(line);
+        auto it = site_index.find(key);
+        if (it != site_index.end()) {
+            return it->second;
+        }
+        int site = static_cast<int>(sites.size());
+        sites.push_back(Site{source, line, function});
+        site_index.emplace(std::move(key), site);
+        return site;
+    }
+
+    void charge() {
+        double now = now_ms();
+        uint64_t allocations = memory ? memory->allocations() : 0;
+        if (current_site >= 0) {
+            double elapsed = now - last_time;
+            LineStats& line = stats[current_site];
+            line.time_ms += elapsed;
+            line.allocations += allocations - last_allocations;
+            stacks[path + ':' + std::to_string(sites[current_site].line)] += elapsed;
+        }
+        last_time = now;
+        last_allocations = allocations;
+    }
+
+    void pop() {
+        path.resize(stack.back().path_length);
+        current_site = stack.back().caller_site;
+        stack.pop_back();
+    }
+};
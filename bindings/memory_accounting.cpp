@@ -0,0 +1,159 @@
+#include "memory_accounting.hpp"
+#include <cstdlib>
+
+namespace {
+
+thread_local MemoryAccount* active_account = nullptr;
+
+#ifndef LAMINA_NO_ALLOCATOR_HOOKS
+
+// Prefix of every block handed out by operator new. Kept at 16 bytes so the
+// user pointer keeps malloc's alignment
+struct AllocationHeader {
+    MemoryAccount* account;
+    size_t size;
+};
+
+constexpr size_t HEADER_SIZE = 16;
+static_assert(sizeof(AllocationHeader) <= HEADER_SIZE, "allocation header too large");
+
+void* allocate(size_t size, bool nothrow) {
+    MemoryAccount* account = active_account;
+    if (account && !account->charge(size)) {
+        if (nothrow) {
+            return nullptr;
+        }
+        throw MemoryQuotaExceeded();
+    }
+
+    void* block = std::malloc(HEADER_SIZE + size);
+    if (!block) {
+        if (account) {
+            account->credit(size);
+        }
+        if (nothrow) {
+            return nullptr;
+        }
+        throw std::bad_alloc();
+    }
+
+    auto* header = static_cast<AllocationHeader*>(block);
+    header->account = account;
+    header->size = size;
+    return static_cast<char*>(block) + HEADER_SIZE;
+}
+
+void deallocate(void* ptr) noexcept {
+    if (!ptr) {
+        return;
+    }
+    void* block = static_cast<char*>(ptr) - HEADER_SIZE;
+    auto* header = static_cast<AllocationHeader*>(block);
+    MemoryAccount* account = header->account;
+    size_t size = header->size;
+    std::free(block);
+
+    if (account) {
+        account->credit(size);
+    }
+}
+
+#endif
+
+} // namespace
+
+MemoryAccount::Scope::Scope(MemoryAccount* account) : previous(active_account) {
+    if (account) {
+        account->exceeded = false;
+    }
+    active_account = account;
+}
+
+MemoryAccount::Scope::~Scope() {
+    active_account = previous;
+}
+
+void MemoryAccount::retire() {
+    release();
+}
+
+// Drop one holder, the owner or a block; the last one frees the account
+void MemoryAccount::release() {
+    if (holders.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete this;
+    }
+}
+
+bool MemoryAccount::charge(size_t bytes) {
+    size_t before = live_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    // Once the quota has been hit, unwinding and error reporting in the same
+    // scope may still allocate up to UNWIND_HEADROOM over it
+    if (quota_bytes > 0) {
+        size_t limit = exceeded ? quota_bytes + UNWIND_HEADROOM : quota_bytes;
+        if (before > limit || bytes > limit - before) {
+            live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+            exceeded = true;
+            return false;
+        }
+    }
+    holders.fetch_add(1, std::memory_order_relaxed);
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    size_t now = before + bytes;
+    size_t peak = peak_bytes.load(std::memory_order_relaxed);
+    while (now > peak && !peak_bytes.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+    }
+    return true;
+}
+
+void MemoryAccount::credit(size_t bytes) {
+    live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    release();
+}
+
+#ifndef LAMINA_NO_ALLOCATOR_HOOKS
+
+// Replacements of the global allocation functions. The aligned overloads
+// are left alone: they allocate through aligned_alloc and are never
+// charged, which keeps the header logic free of alignment cases
+
+void* operator new(size_t size) {
+    return allocate(size, false);
+}
+
+void* operator new[](size_t size) {
+    return allocate(size, false);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size, true);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size, true);
+}
+
+void operator delete(void* ptr) noexcept {
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    deallocate(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    deallocate(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    deallocate(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    deallocate(ptr);
+}
+
+#endif
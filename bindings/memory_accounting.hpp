@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+/**
+ * Thrown when an allocation would take an account over its quota
+ * Derives from std::bad_alloc so existing handlers treat it as OOM
+ */
+class MemoryQuotaExceeded : public std::bad_alloc {
+public:
+    const char* what() const noexcept override {
+        return "Memory quota exceeded";
+    }
+};
+
+/**
+ * Live heap usage charged to one interpreter
+ *
+ * The global operator new (memory_accounting.cpp) prefixes every block with
+ * a small header naming the account that was active when it was allocated,
+ * so the block is credited back to the same account when it is freed, even
+ * if that happens in a later call or from another wrapper sharing the
+ * state. An account is therefore retired rather than deleted: it is freed
+ * once its owner is gone and the last block charged to it is released.
+ * Blocks may be freed on any thread, e.g. on parallel_for workers in the
+ * threaded build, so the counters are atomic; charging only happens on the
+ * thread the account is active on.
+ *
+ * Builds that cannot replace operator new, such as the Node-API addon
+ * whose allocations mix with the host's, define LAMINA_NO_ALLOCATOR_HOOKS:
+ * nothing is charged then and quotas are not enforced.
+ */
+class MemoryAccount {
+public:
+    /**
+     * Makes an account active for the current thread while in scope
+     * Allocations made outside any scope are not charged; a null account
+     * pauses charging, e.g. for bookkeeping done on behalf of a script
+     */
+    class Scope {
+    public:
+        explicit Scope(MemoryAccount* account);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        MemoryAccount* previous;
+    };
+
+    // Allowance over the quota once it has been hit, for unwinding and
+    // reporting the error; peak usage stays within quota + UNWIND_HEADROOM
+    static constexpr size_t UNWIND_HEADROOM = 16 * 1024;
+
+    static MemoryAccount* create() {
+        return new MemoryAccount();
+    }
+
+    /**
+     * Release the owner's reference; see the class comment
+     */
+    void retire();
+
+    /**
+     * Set the quota in bytes, 0 for unlimited
+     */
+    void set_quota(size_t bytes) {
+        quota_bytes = bytes;
+    }
+
+    size_t quota() const { return quota_bytes; }
+    size_t live() const { return live_bytes.load(std::memory_order_relaxed); }
+    size_t peak() const { return peak_bytes.load(std::memory_order_relaxed); }
+    uint64_t allocations() const { return allocation_count.load(std::memory_order_relaxed); }
+
+    /**
+     * Whether an allocation failed on the quota in the last scope
+     */
+    bool tripped() const {
+        return exceeded;
+    }
+
+    // Called by the global allocation functions only
+    bool charge(size_t bytes);
+    void credit(size_t bytes);
+
+private:
+    size_t quota_bytes = 0;
+    std::atomic<size_t> live_bytes{0};
+    std::atomic<size_t> peak_bytes{0};
+    std::atomic<uint64_t> allocation_count{0};
+    bool exceeded = false;
+    // The owner plus one per live block; the account is freed at zero
+    std::atomic<size_t> holders{1};
+
+    MemoryAccount() = default;
+    ~MemoryAccount() = default;
+
+    void release();
+};
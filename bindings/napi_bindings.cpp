@@ -0,0 +1,1130 @@
+/**
+ * Node-API addon exposing the same module interface as the WASM build
+ *
+ * src/interpreter.ts loads lib/lamina.node in Node.js when it exists and
+ * falls back to lib/lamina.js otherwise, so this module mirrors the embind
+ * one: a LaminaInterpreter class with the same methods, the standalone
+ * functions, and _malloc/_free/HEAP* for the methods that take buffers.
+ *
+ * There is no WASM heap to hand out addresses in, so _malloc() allocates
+ * from a StagingHeap: an ArrayBuffer owned by the addon whose offsets play
+ * the role of heap addresses. Methods taking addresses translate them to
+ * pointers into that buffer.
+ *
+ * Objects are bound to the thread that created them; every worker thread
+ * gets its own heap and interpreter pool. Written against the C Node-API
+ * so that building needs nothing beyond the Node.js headers.
+ */
+
+#include <node_api.h>
+#include "lamina_interpreter.hpp"
+#include "value_conversion.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/**
+ * Thrown when a Node-API call failed and left a JS exception pending
+ */
+struct PendingException {};
+
+void check(napi_env env, napi_status status) {
+    if (status == napi_ok) {
+        return;
+    }
+    bool pending = false;
+    napi_is_exception_pending(env, &pending);
+    if (pending) {
+        throw PendingException{};
+    }
+    const napi_extended_error_info* info = nullptr;
+    napi_get_last_error_info(env, &info);
+    throw std::runtime_error(info && info->error_message ? info->error_message : "Node-API call failed");
+}
+
+/**
+ * Arguments of a call from JavaScript
+ */
+struct Call {
+    static constexpr size_t MAX_ARGS = 8;
+
+    napi_env env;
+    napi_value self = nullptr;
+    napi_value args[MAX_ARGS] = {};
+    size_t argc = MAX_ARGS;
+    void* data = nullptr;
+
+    Call(napi_env env, napi_callback_info info) : env(env) {
+        check(env, napi_get_cb_info(env, info, &argc, args, &self, &data));
+    }
+
+    napi_value arg(size_t index) const {
+        if (index >= argc) {
+            throw std::invalid_argument("Expected at least " + std::to_string(index + 1) + " arguments");
+        }
+        return args[index];
+    }
+};
+
+/**
+ * Node-API callback running body with C++ exceptions turned into JS ones
+ */
+template <napi_value (*Body)(Call&)>
+napi_value callback(napi_env env, napi_callback_info info) {
+    try {
+        Call call(env, info);
+        return Body(call);
+    } catch (const PendingException&) {
+    } catch (const std::exception& e) {
+        napi_throw_error(env, nullptr, e.what());
+    } catch (...) {
+        napi_throw_error(env, nullptr, "Unknown C++ exception");
+    }
+    return nullptr;
+}
+
+// Conversion between JavaScript and C++ values
+
+template <typename T>
+T from_js(napi_env env, napi_value value);
+
+template <>
+double from_js<double>(napi_env env, napi_value value) {
+    double result;
+    check(env, napi_get_value_double(env, value, &result));
+    return result;
+}
+
+template <>
+int from_js<int>(napi_env env, napi_value value) {
+    int32_t result;
+    check(env, napi_get_value_int32(env, value, &result));
+    return result;
+}
+
+template <>
+uint32_t from_js<uint32_t>(napi_env env, napi_value value) {
+    uint32_t result;
+    check(env, napi_get_value_uint32(env, value, &result));
+    return result;
+}
+
+template <>
+size_t from_js<size_t>(napi_env env, napi_value value) {
+    int64_t result;
+    check(env, napi_get_value_int64(env, value, &result));
+    return result > 0 ? static_cast<size_t>(result) : 0;
+}
+
+template <>
+bool from_js<bool>(napi_env env, napi_value value) {
+    napi_value coerced;
+    bool result;
+    check(env, napi_coerce_to_bool(env, value, &coerced));
+    check(env, napi_get_value_bool(env, coerced, &result));
+    return result;
+}
+
+template <>
+std::string from_js<std::string>(napi_env env, napi_value value) {
+    size_t length;
+    check(env, napi_get_value_string_utf8(env, value, nullptr, 0, &length));
+    std::string result(length, '\0');
+    check(env, napi_get_value_string_utf8(env, value, result.data(), length + 1, &length));
+    return result;
+}
+
+napi_value to_js(napi_env env, double value) {
+    napi_value result;
+    check(env, napi_create_double(env, value, &result));
+    return result;
+}
+
+napi_value to_js(napi_env env, int value) {
+    napi_value result;
+    check(env, napi_create_int32(env, value, &result));
+    return result;
+}
+
+napi_value to_js(napi_env env, bool value) {
+    napi_value result;
+    check(env, napi_get_boolean(env, value, &result));
+    return result;
+}
+
+napi_value to_js(napi_env env, const std::string& value) {
+    napi_value result;
+    check(env, napi_create_string_utf8(env, value.data(), value.size(), &result));
+    return result;
+}
+
+napi_value to_js(napi_env env, const char* value) {
+    napi_value result;
+    check(env, napi_create_string_utf8(env, value, NAPI_AUTO_LENGTH, &result));
+    return result;
+}
+
+napi_value undefined(napi_env env) {
+    napi_value result;
+    check(env, napi_get_undefined(env, &result));
+    return result;
+}
+
+napi_value new_object(napi_env env) {
+    napi_value result;
+    check(env, napi_create_object(env, &result));
+    return result;
+}
+
+napi_value new_array(napi_env env, size_t length) {
+    napi_value result;
+    check(env, napi_create_array_with_length(env, length, &result));
+    return result;
+}
+
+template <typename T>
+void set(napi_env env, napi_value object, const char* key, const T& value) {
+    if constexpr (std::is_same_v<T, napi_value>) {
+        check(env, napi_set_named_property(env, object, key, value));
+    } else {
+        check(env, napi_set_named_property(env, object, key, to_js(env, value)));
+    }
+}
+
+void set(napi_env env, napi_value array, size_t index, napi_value value) {
+    check(env, napi_set_element(env, array, static_cast<uint32_t>(index), value));
+}
+
+/**
+ * Create a typed array holding a copy of count elements
+ */
+template <typename T>
+napi_value typed_array(napi_env env, napi_typedarray_type type, const T* data, size_t count) {
+    void* bytes;
+    napi_value buffer, result;
+    check(env, napi_create_arraybuffer(env, count * sizeof(T), &bytes, &buffer));
+    if (count > 0) {
+        std::memcpy(bytes, data, count * sizeof(T));
+    }
+    check(env, napi_create_typedarray(env, type, count, buffer, 0, &result));
+    return result;
+}
+
+/**
+ * Bump allocator over an ArrayBuffer, standing in for the WASM heap
+ * The wrapper only allocates for the duration of a call, so the heap is
+ * rewound whenever nothing is live. Growing replaces the ArrayBuffer and
+ * detaches the old one, like WASM memory growth does, so stale views fail
+ * instead of reading freed memory
+ */
+class StagingHeap {
+public:
+    static constexpr size_t ALIGNMENT = 16;
+    static constexpr size_t INITIAL_SIZE = 64 * 1024;
+
+    /**
+     * @return Heap address of size bytes, never 0
+     */
+    uint32_t allocate(napi_env env, size_t size) {
+        // Address 0 stays unused so that no allocation looks like null
+        size_t offset = std::max((top + ALIGNMENT - 1) & ~(ALIGNMENT - 1), ALIGNMENT);
+        if (offset + size > capacity || !buffer) {
+            grow(env, offset + size);
+        }
+        top = offset + size;
+        ++live;
+        return static_cast<uint32_t>(offset);
+    }
+
+    void release(uint32_t address) {
+        if (address == 0 || live == 0) {
+            return;
+        }
+        if (--live == 0) {
+            top = 0;
+        }
+    }
+
+    /**
+     * Pointer for a heap address
+     */
+    template <typename T>
+    T* at(uint32_t address) const {
+        if (address >= capacity) {
+            throw std::out_of_range("Heap address out of range");
+        }
+        return reinterpret_cast<T*>(data + address);
+    }
+
+    napi_value array_buffer(napi_env env) {
+        if (!buffer) {
+            grow(env, INITIAL_SIZE);
+        }
+        napi_value result;
+        check(env, napi_get_reference_value(env, buffer, &result));
+        return result;
+    }
+
+    size_t size() const {
+        return capacity;
+    }
+
+    void destroy(napi_env env) {
+        if (buffer) {
+            napi_delete_reference(env, buffer);
+            buffer = nullptr;
+        }
+    }
+
+private:
+    napi_ref buffer = nullptr;
+    uint8_t* data = nullptr;
+    size_t capacity = 0;
+    size_t top = 0;
+    size_t live = 0;
+
+    void grow(napi_env env, size_t needed) {
+        size_t size = std::max(capacity * 2, INITIAL_SIZE);
+        while (size < needed) {
+            size *= 2;
+        }
+
+        void* bytes;
+        napi_value grown;
+        check(env, napi_create_arraybuffer(env, size, &bytes, &grown));
+        if (buffer) {
+            std::memcpy(bytes, data, top);
+            napi_value old = array_buffer(env);
+            check(env, napi_detach_arraybuffer(env, old));
+            check(env, napi_delete_reference(env, buffer));
+        }
+        check(env, napi_create_reference(env, grown, 1, &buffer));
+        data = static_cast<uint8_t*>(bytes);
+        capacity = size;
+    }
+};
+
+/**
+ * Per-environment state, one per main or worker thread
+ */
+struct AddonData {
+    napi_ref interpreter_class = nullptr;
+    napi_ref snapshot_class = nullptr;
+    StagingHeap heap;
+};
+
+AddonData& addon_data(napi_env env) {
+    void* data = nullptr;
+    check(env, napi_get_instance_data(env, &data));
+    return *static_cast<AddonData*>(data);
+}
+
+napi_value construct(napi_env env, napi_ref constructor, void* native) {
+    napi_value cls, external, result;
+    check(env, napi_get_reference_value(env, constructor, &cls));
+    check(env, napi_create_external(env, native, nullptr, nullptr, &external));
+    check(env, napi_new_instance(env, cls, 1, &external, &result));
+    return result;
+}
+
+/**
+ * Builds the JS values chosen by convert_value()
+ */
+struct JsBuilder {
+    using Result = napi_value;
+
+    napi_env env;
+
+    napi_value null() {
+        napi_value result;
+        check(env, napi_get_null(env, &result));
+        return result;
+    }
+
+    napi_value boolean(bool value) { return to_js(env, value); }
+    napi_value integer(int value) { return to_js(env, value); }
+    napi_value number(double value) { return to_js(env, value); }
+    napi_value string(const std::string& value) { return to_js(env, value); }
+
+    napi_value bigint(const ::BigInt& value) {
+        napi_value global, constructor, result;
+        napi_value text = to_js(env, value.to_string());
+        check(env, napi_get_global(env, &global));
+        check(env, napi_get_named_property(env, global, "BigInt", &constructor));
+        check(env, napi_call_function(env, global, constructor, 1, &text, &result));
+        return result;
+    }
+
+    napi_value rational(const ::BigInt& num, const ::BigInt& den) {
+        napi_value result = new_object(env);
+        set(env, result, "type", "rational");
+        set(env, result, "num", bigint(num));
+        set(env, result, "den", bigint(den));
+        return result;
+    }
+
+    napi_value tensor(const char* type, const std::vector<double>& data,
+                      std::initializer_list<size_t> shape) {
+        napi_value dims = new_array(env, shape.size());
+        size_t i = 0;
+        for (size_t dim : shape) {
+            set(env, dims, i++, to_js(env, static_cast<double>(dim)));
+        }
+        napi_value result = new_object(env);
+        set(env, result, "type", type);
+        set(env, result, "data", typed_array(env, napi_float64_array, data.data(), data.size()));
+        set(env, result, "shape", dims);
+        return result;
+    }
+
+    napi_value array(size_t size) { return new_array(env, size); }
+    void element(napi_value array, size_t index, napi_value item) { set(env, array, index, item); }
+
+    napi_value symbolic(const std::string& text, double approx) {
+        napi_value result = new_object(env);
+        set(env, result, "type", "symbolic");
+        set(env, result, "text", text);
+        set(env, result, "approx", approx);
+        return result;
+    }
+
+    napi_value other(const std::string& text) {
+        napi_value result = new_object(env);
+        set(env, result, "type", "other");
+        set(env, result, "text", text);
+        return result;
+    }
+};
+
+/**
+ * Convert a Lamina value into a JavaScript value
+ * See value_conversion.hpp for the mapping
+ */
+napi_value value_to_js(napi_env env, const Value& value) {
+    JsBuilder builder{env};
+    return convert_value(value, builder);
+}
+
+napi_value error_to_js(napi_env env, const std::string& message) {
+    napi_value result = new_object(env);
+    set(env, result, "type", "error");
+    set(env, result, "message", message);
+    return result;
+}
+
+// InterpreterSnapshot: opaque handle with delete()
+
+InterpreterSnapshot*& snapshot_slot(Call& call) {
+    void* wrapped = nullptr;
+    check(call.env, napi_unwrap(call.env, call.self, &wrapped));
+    return *static_cast<InterpreterSnapshot**>(wrapped);
+}
+
+napi_value snapshot_new(Call& call) {
+    void* native = nullptr;
+    if (call.argc > 0) {
+        napi_get_value_external(call.env, call.args[0], &native);
+    }
+    if (!native) {
+        throw std::invalid_argument("InterpreterSnapshot is created by LaminaInterpreter.snapshot()");
+    }
+    auto* slot = new InterpreterSnapshot*(static_cast<InterpreterSnapshot*>(native));
+    check(call.env, napi_wrap(call.env, call.self, slot, [](napi_env, void* data, void*) {
+        auto* slot = static_cast<InterpreterSnapshot**>(data);
+        delete *slot;
+        delete slot;
+    }, nullptr, nullptr));
+    return call.self;
+}
+
+napi_value snapshot_delete(Call& call) {
+    InterpreterSnapshot*& snapshot = snapshot_slot(call);
+    delete snapshot;
+    snapshot = nullptr;
+    return undefined(call.env);
+}
+
+// LaminaInterpreter
+
+/**
+ * Native side of a LaminaInterpreter object
+ * Busy while an executeAsync() call on it is in flight, during which every
+ * other method throws
+ */
+struct NativeInterpreter {
+    std::unique_ptr<LaminaInterpreter> interpreter;
+    bool busy = false;
+};
+
+NativeInterpreter& native(Call& call) {
+    void* wrapped = nullptr;
+    check(call.env, napi_unwrap(call.env, call.self, &wrapped));
+    auto& native = *static_cast<NativeInterpreter*>(wrapped);
+    if (native.busy) {
+        throw std::logic_error("LaminaInterpreter is busy running executeAsync()");
+    }
+    return native;
+}
+
+LaminaInterpreter& self(Call& call) {
+    auto& interpreter = native(call).interpreter;
+    if (!interpreter) {
+        throw std::logic_error("LaminaInterpreter has been deleted");
+    }
+    return *interpreter;
+}
+
+StagingHeap& heap(Call& call) {
+    return addon_data(call.env).heap;
+}
+
+uint32_t address(Call& call, size_t index) {
+    return from_js<uint32_t>(call.env, call.arg(index));
+}
+
+/**
+ * new LaminaInterpreter(), or adopt a native instance passed as an
+ * external (used by fork())
+ */
+napi_value interpreter_new(Call& call) {
+    void* adopted = nullptr;
+    if (call.argc > 0) {
+        napi_valuetype type;
+        check(call.env, napi_typeof(call.env, call.args[0], &type));
+        if (type == napi_external) {
+            check(call.env, napi_get_value_external(call.env, call.args[0], &adopted));
+        }
+    }
+    auto* native = new NativeInterpreter{
+        std::unique_ptr<LaminaInterpreter>(adopted ? static_cast<LaminaInterpreter*>(adopted) : new LaminaInterpreter())};
+    napi_status status = napi_wrap(call.env, call.self, native, [](napi_env, void* data, void*) {
+        delete static_cast<NativeInterpreter*>(data);
+    }, nullptr, nullptr);
+    if (status != napi_ok) {
+        delete native;
+        check(call.env, status);
+    }
+    return call.self;
+}
+
+template <typename R, typename... Args, typename Fn, size_t... I>
+napi_value invoke_with(Call& call, Fn fn, std::index_sequence<I...>) {
+    LaminaInterpreter& target = self(call);
+    if constexpr (std::is_void_v<R>) {
+        fn(target, from_js<std::decay_t<Args>>(call.env, call.arg(I))...);
+        return undefined(call.env);
+    } else {
+        return to_js(call.env, fn(target, from_js<std::decay_t<Args>>(call.env, call.arg(I))...));
+    }
+}
+
+template <typename R, typename... Args>
+napi_value invoke(Call& call, R (LaminaInterpreter::*method)(Args...)) {
+    return invoke_with<R, Args...>(call, [method](LaminaInterpreter& target, auto&&... args) -> R {
+        return (target.*method)(std::forward<decltype(args)>(args)...);
+    }, std::index_sequence_for<Args...>{});
+}
+
+template <typename R, typename... Args>
+napi_value invoke(Call& call, R (LaminaInterpreter::*method)(Args...) const) {
+    return invoke_with<R, Args...>(call, [method](LaminaInterpreter& target, auto&&... args) -> R {
+        return (target.*method)(std::forward<decltype(args)>(args)...);
+    }, std::index_sequence_for<Args...>{});
+}
+
+/**
+ * Bind a LaminaInterpreter method whose arguments and result map directly
+ * to JS numbers, booleans and strings
+ */
+template <auto Method>
+napi_value bound(Call& call) {
+    return invoke(call, Method);
+}
+
+napi_value resultValue(Call& call) {
+    return value_to_js(call.env, self(call).take_result());
+}
+
+/**
+ * evalString(expression): the result as a string, or the ErrorKind of the
+ * failure as a number, as in the WASM build
+ */
+napi_value evalString(Call& call) {
+    LaminaInterpreter& interp = self(call);
+    int status = interp.evalStatus(from_js<std::string>(call.env, call.arg(0)));
+    if (status != 0) {
+        return to_js(call.env, status);
+    }
+    return to_js(call.env, interp.resultString());
+}
+
+/**
+ * evaluateString(handle), see evalString()
+ */
+napi_value evaluateString(Call& call) {
+    LaminaInterpreter& interp = self(call);
+    int status = interp.evaluateStatus(from_js<int>(call.env, call.arg(0)));
+    if (status != 0) {
+        return to_js(call.env, status);
+    }
+    return to_js(call.env, interp.resultString());
+}
+
+napi_value evalValue(Call& call) {
+    Value value;
+    std::string error;
+    if (!self(call).evaluate_value(from_js<std::string>(call.env, call.arg(0)), value, error)) {
+        return error_to_js(call.env, error);
+    }
+    return value_to_js(call.env, value);
+}
+
+/**
+ * evaluateColumns(handle, names, nameOffsets, columns, columnCount, rows, out)
+ * with staging heap addresses, as in the WASM build
+ */
+napi_value evaluateColumns(Call& call) {
+    StagingHeap& memory = heap(call);
+    size_t count = from_js<size_t>(call.env, call.arg(4));
+    const uint32_t* table = memory.at<uint32_t>(address(call, 3));
+    std::vector<const double*> columns;
+    columns.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        columns.push_back(memory.at<double>(table[i]));
+    }
+    int status = self(call).evaluateColumns(
+        from_js<int>(call.env, call.arg(0)), memory.at<char>(address(call, 1)),
+        memory.at<uint32_t>(address(call, 2)), columns.data(), count, from_js<size_t>(call.env, call.arg(5)),
+        memory.at<double>(address(call, 6)));
+    return to_js(call.env, status);
+}
+
+napi_value memoryUsage(Call& call) {
+    const MemoryAccount& memory = self(call).memory_account();
+    napi_value usage = new_object(call.env);
+    set(call.env, usage, "live", static_cast<double>(memory.live()));
+    set(call.env, usage, "peak", static_cast<double>(memory.peak()));
+    set(call.env, usage, "quota", static_cast<double>(memory.quota()));
+    return usage;
+}
+
+napi_value getProfile(Call& call) {
+    napi_env env = call.env;
+    auto rows = self(call).profile_rows();
+    napi_value result = new_array(env, rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const auto& entry = *rows[i].second;
+        napi_value arg_types = new_object(env);
+        for (size_t type = 0; type < BuiltinProfiler::ARG_TYPES.size(); ++type) {
+            if (entry.arg_types[type] > 0) {
+                set(env, arg_types, BuiltinProfiler::ARG_TYPES[type], static_cast<double>(entry.arg_types[type]));
+            }
+        }
+        napi_value row = new_object(env);
+        set(env, row, "name", *rows[i].first);
+        set(env, row, "calls", static_cast<double>(entry.calls));
+        set(env, row, "totalMs", entry.total_ms);
+        set(env, row, "selfMs", entry.self_ms);
+        set(env, row, "argTypes", arg_types);
+        set(env, result, i, row);
+    }
+    return result;
+}
+
+napi_value getLineProfile(Call& call) {
+    napi_env env = call.env;
+    auto rows = self(call).line_rows();
+    napi_value result = new_array(env, rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const auto& site = *rows[i].first;
+        const auto& stats = *rows[i].second;
+        napi_value row = new_object(env);
+        set(env, row, "source", site.source);
+        set(env, row, "line", site.line);
+        set(env, row, "function", site.function.empty() ? std::string(LineProfiler::ROOT_FRAME) : site.function);
+        set(env, row, "hits", static_cast<double>(stats.hits));
+        set(env, row, "timeMs", stats.time_ms);
+        set(env, row, "allocations", static_cast<double>(stats.allocations));
+        set(env, result, i, row);
+    }
+    return result;
+}
+
+napi_value getParseCacheStats(Call& call) {
+    napi_env env = call.env;
+    const ParseCache& cache = self(call).program_cache();
+    napi_value stats = new_object(env);
+    set(env, stats, "hits", static_cast<double>(cache.hits()));
+    set(env, stats, "misses", static_cast<double>(cache.misses()));
+    set(env, stats, "entries", static_cast<double>(cache.size()));
+    set(env, stats, "bytes", static_cast<double>(cache.bytes()));
+    set(env, stats, "maxEntries", static_cast<double>(cache.max_entries()));
+    set(env, stats, "maxBytes", static_cast<double>(cache.max_bytes()));
+    return stats;
+}
+
+/**
+ * Captured output as a Uint8Array
+ * A copy rather than a view: the buffer is not in JS-visible memory
+ */
+napi_value outputView(Call& call) {
+    const std::string& data = self(call).captured_output();
+    return typed_array(call.env, napi_uint8_array, reinterpret_cast<const uint8_t*>(data.data()), data.size());
+}
+
+napi_value evalBatch(Call& call) {
+    napi_env env = call.env;
+    StagingHeap& memory = heap(call);
+    const BatchResult& batch = self(call).evalBatch(memory.at<char>(address(call, 0)),
+                                                    memory.at<uint32_t>(address(call, 1)),
+                                                    from_js<size_t>(env, call.arg(2)));
+    napi_value result = new_object(env);
+    set(env, result, "data", typed_array(env, napi_uint8_array,
+        reinterpret_cast<const uint8_t*>(batch.data.data()), batch.data.size()));
+    set(env, result, "offsets", typed_array(env, napi_uint32_array, batch.offsets.data(), batch.offsets.size()));
+    set(env, result, "errors", typed_array(env, napi_uint8_array, batch.errors.data(), batch.errors.size()));
+    return result;
+}
+
+napi_value executeBytes(Call& call) {
+    int status = self(call).executeBytes(heap(call).at<char>(address(call, 0)), from_js<size_t>(call.env, call.arg(1)));
+    return to_js(call.env, status);
+}
+
+napi_value appendSource(Call& call) {
+    self(call).appendSource(heap(call).at<char>(address(call, 0)), from_js<size_t>(call.env, call.arg(1)));
+    return undefined(call.env);
+}
+
+napi_value bindVariables(Call& call) {
+    StagingHeap& memory = heap(call);
+    self(call).bindVariables(memory.at<char>(address(call, 0)), memory.at<uint32_t>(address(call, 1)),
+                             memory.at<double>(address(call, 2)), from_js<size_t>(call.env, call.arg(3)));
+    return undefined(call.env);
+}
+
+napi_value bindArray(Call& call) {
+    self(call).bindArray(from_js<std::string>(call.env, call.arg(0)), heap(call).at<void>(address(call, 1)),
+                         from_js<size_t>(call.env, call.arg(2)), from_js<bool>(call.env, call.arg(3)));
+    return undefined(call.env);
+}
+
+napi_value getVariableValue(Call& call) {
+    Value value;
+    std::string error;
+    if (!self(call).variable_value(from_js<std::string>(call.env, call.arg(0)), value, error)) {
+        return error_to_js(call.env, error);
+    }
+    return value_to_js(call.env, value);
+}
+
+napi_value snapshot(Call& call) {
+    auto* state = new InterpreterSnapshot(self(call).snapshot());
+    return construct(call.env, addon_data(call.env).snapshot_class, state);
+}
+
+napi_value restore(Call& call) {
+    void* wrapped = nullptr;
+    check(call.env, napi_unwrap(call.env, call.arg(0), &wrapped));
+    InterpreterSnapshot* state = *static_cast<InterpreterSnapshot**>(wrapped);
+    if (!state) {
+        throw std::logic_error("InterpreterSnapshot has been deleted");
+    }
+    self(call).restore(*state);
+    return undefined(call.env);
+}
+
+napi_value fork(Call& call) {
+    auto forked = self(call).fork();
+    napi_value result = construct(call.env, addon_data(call.env).interpreter_class, forked.get());
+    forked.release();
+    return result;
+}
+
+/**
+ * Free the native interpreter now rather than at garbage collection,
+ * like delete() on embind objects
+ */
+napi_value interpreter_delete(Call& call) {
+    native(call).interpreter.reset();
+    return undefined(call.env);
+}
+
+/**
+ * An executeAsync() call in flight
+ *
+ * The code runs on a thread of its own, which takes turns with the JS
+ * thread rather than running alongside it: the JS thread waits while a
+ * slice runs, and the call's thread waits at each yield until a later
+ * task hands it the next slice. So, as in the JSPI build, Lamina code only
+ * ever runs on behalf of one interpreter of the environment at a time, and
+ * the Lamina core is never entered from two threads at once.
+ * Holds a reference to the JS object so that it outlives the call
+ */
+struct AsyncExecution {
+    NativeInterpreter* native;
+    std::string code;
+    double slice_steps = 0;
+    double slice_ms = 0;
+    int status = 0;
+    napi_ref owner = nullptr;
+    napi_deferred deferred = nullptr;
+    std::thread thread;
+
+    std::mutex mutex;
+    std::condition_variable handed_over;
+    bool script_turn = false;
+    bool finished = false;
+    bool abandoned = false;
+
+    /**
+     * Start the call and run its first slice
+     */
+    void start() {
+        script_turn = true;
+        thread = std::thread([this] {
+            int result = native->interpreter->executeSliced(code, slice_steps, slice_ms, [this] { yield(); });
+            std::lock_guard<std::mutex> lock(mutex);
+            status = result;
+            finished = true;
+            script_turn = false;
+            handed_over.notify_all();
+        });
+        wait_for_host();
+    }
+
+    /**
+     * Run the next slice, from the JS thread
+     */
+    void resume() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            script_turn = true;
+        }
+        handed_over.notify_all();
+        wait_for_host();
+    }
+
+    /**
+     * Unwind a suspended call whose environment is shutting down
+     * The next yield throws, which fails the call like any other error
+     */
+    void abandon() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            abandoned = true;
+        }
+        while (!finished) {
+            resume();
+        }
+        thread.join();
+    }
+
+private:
+    void wait_for_host() {
+        std::unique_lock<std::mutex> lock(mutex);
+        handed_over.wait(lock, [this] { return !script_turn; });
+    }
+
+    /**
+     * Hand the turn to the JS thread and wait for it back, on the call's thread
+     */
+    void yield() {
+        std::unique_lock<std::mutex> lock(mutex);
+        script_turn = false;
+        handed_over.notify_all();
+        handed_over.wait(lock, [this] { return script_turn; });
+        if (abandoned) {
+            throw std::runtime_error("executeAsync() was abandoned");
+        }
+    }
+};
+
+void abandon_execution(void* data) {
+    auto* job = static_cast<AsyncExecution*>(data);
+    job->abandon();
+    delete job;
+}
+
+/**
+ * Settle the promise once the call has finished, or schedule its next
+ * slice in a later task
+ */
+void continue_execution(napi_env env, AsyncExecution* job);
+
+napi_value resume_execution(Call& call) {
+    auto* job = static_cast<AsyncExecution*>(call.data);
+    job->resume();
+    continue_execution(call.env, job);
+    return undefined(call.env);
+}
+
+void continue_execution(napi_env env, AsyncExecution* job) {
+    if (!job->finished) {
+        napi_value global, set_immediate, resume, immediate;
+        check(env, napi_get_global(env, &global));
+        check(env, napi_get_named_property(env, global, "setImmediate", &set_immediate));
+        check(env, napi_create_function(env, "resume", NAPI_AUTO_LENGTH, callback<resume_execution>, job,
+                                        &resume));
+        check(env, napi_call_function(env, global, set_immediate, 1, &resume, &immediate));
+        return;
+    }
+
+    std::unique_ptr<AsyncExecution> done(job);
+    done->thread.join();
+    napi_remove_env_cleanup_hook(env, abandon_execution, job);
+    done->native->busy = false;
+    napi_value result;
+    napi_create_int32(env, done->status, &result);
+    napi_resolve_deferred(env, done->deferred, result);
+    napi_delete_reference(env, done->owner);
+}
+
+/**
+ * executeAsync(code, sliceSteps, sliceMs), resolving with the status of
+ * executeStatus()
+ * Yields to the event loop between slices like the JSPI build, see
+ * AsyncExecution. The first slice runs before this returns
+ */
+napi_value executeAsync(Call& call) {
+    napi_env env = call.env;
+    NativeInterpreter& target = native(call);
+    if (!target.interpreter) {
+        throw std::logic_error("LaminaInterpreter has been deleted");
+    }
+    auto job = std::make_unique<AsyncExecution>();
+    job->native = &target;
+    job->code = from_js<std::string>(env, call.arg(0));
+    job->slice_steps = call.argc > 1 ? from_js<double>(env, call.args[1]) : 0;
+    job->slice_ms = call.argc > 2 ? from_js<double>(env, call.args[2]) : 0;
+
+    napi_value promise;
+    check(env, napi_create_promise(env, &job->deferred, &promise));
+    check(env, napi_create_reference(env, call.self, 1, &job->owner));
+    check(env, napi_add_env_cleanup_hook(env, abandon_execution, job.get()));
+    target.busy = true;
+    job->start();
+    continue_execution(env, job.release());
+    return promise;
+}
+
+napi_value getVersion(Call& call) {
+    return to_js(call.env, LaminaInterpreter::getVersion());
+}
+
+// Standalone functions
+
+napi_value evaluateExpression(Call& call) {
+    auto interp = interpreter_pool().acquire();
+    return to_js(call.env, interp->eval(from_js<std::string>(call.env, call.arg(0))));
+}
+
+napi_value evaluateExpressionValue(Call& call) {
+    auto interp = interpreter_pool().acquire();
+    Value value;
+    std::string error;
+    if (!interp->evaluate_value(from_js<std::string>(call.env, call.arg(0)), value, error)) {
+        return error_to_js(call.env, error);
+    }
+    return value_to_js(call.env, value);
+}
+
+napi_value executeCode(Call& call) {
+    auto interp = interpreter_pool().acquire();
+    return to_js(call.env, interp->execute(from_js<std::string>(call.env, call.arg(0))));
+}
+
+napi_value setInterpreterPoolSize(Call& call) {
+    interpreter_pool().set_capacity(from_js<size_t>(call.env, call.arg(0)));
+    return undefined(call.env);
+}
+
+// Build the prototype interpreter ahead of the first context, see
+// wasm_bindings.cpp
+napi_value warmUp(Call& call) {
+    prototype_interpreter();
+    return undefined(call.env);
+}
+
+napi_value getInterpreterPoolStats(Call& call) {
+    napi_env env = call.env;
+    auto stats = interpreter_pool().stats();
+    napi_value result = new_object(env);
+    set(env, result, "capacity", static_cast<double>(stats.capacity));
+    set(env, result, "idle", static_cast<double>(stats.idle));
+    set(env, result, "created", static_cast<double>(stats.created));
+    set(env, result, "acquired", static_cast<double>(stats.acquired));
+    set(env, result, "reused", static_cast<double>(stats.acquired - stats.created));
+    return result;
+}
+
+// Staging heap, standing in for the WASM module's _malloc/_free/HEAP*
+
+napi_value malloc_(Call& call) {
+    return to_js(call.env, static_cast<double>(heap(call).allocate(call.env, from_js<size_t>(call.env, call.arg(0)))));
+}
+
+napi_value free_(Call& call) {
+    heap(call).release(address(call, 0));
+    return undefined(call.env);
+}
+
+/**
+ * Getter for a HEAP* view; views are made on access so they always cover
+ * the current buffer
+ */
+template <napi_typedarray_type Type, size_t ElementSize>
+napi_value heap_view(Call& call) {
+    StagingHeap& memory = heap(call);
+    napi_value buffer = memory.array_buffer(call.env);
+    napi_value result;
+    check(call.env, napi_create_typedarray(call.env, Type, memory.size() / ElementSize, buffer, 0, &result));
+    return result;
+}
+
+constexpr napi_property_descriptor method(const char* name, napi_callback cb) {
+    return {name, nullptr, cb, nullptr, nullptr, nullptr, napi_default, nullptr};
+}
+
+constexpr napi_property_descriptor static_method(const char* name, napi_callback cb) {
+    return {name, nullptr, cb, nullptr, nullptr, nullptr, napi_static, nullptr};
+}
+
+constexpr napi_property_descriptor getter(const char* name, napi_callback cb) {
+    return {name, nullptr, nullptr, cb, nullptr, nullptr, napi_enumerable, nullptr};
+}
+
+napi_value define_interpreter(napi_env env) {
+    static const napi_property_descriptor methods[] = {
+        method("execute", callback<bound<&LaminaInterpreter::execute>>),
+        method("eval", callback<bound<&LaminaInterpreter::eval>>),
+        method("executeStatus", callback<bound<&LaminaInterpreter::executeStatus>>),
+        method("evalStatus", callback<bound<&LaminaInterpreter::evalStatus>>),
+        method("executeAsync", callback<executeAsync>),
+        method("lastYieldCount", callback<bound<&LaminaInterpreter::lastYieldCount>>),
+        method("executeBytes", callback<executeBytes>),
+        method("appendSource", callback<appendSource>),
+        method("finishSource", callback<bound<&LaminaInterpreter::finishSource>>),
+        method("discardSource", callback<bound<&LaminaInterpreter::discardSource>>),
+        method("evalString", callback<evalString>),
+        method("resultString", callback<bound<&LaminaInterpreter::resultString>>),
+        method("resultValue", callback<resultValue>),
+        method("errorKind", callback<bound<&LaminaInterpreter::errorKind>>),
+        method("errorMessage", callback<bound<&LaminaInterpreter::errorMessage>>),
+        method("errorOffset", callback<bound<&LaminaInterpreter::errorOffset>>),
+        method("evalValue", callback<evalValue>),
+        method("compile", callback<bound<&LaminaInterpreter::compile>>),
+        method("evaluate", callback<bound<&LaminaInterpreter::evaluate>>),
+        method("evaluateString", callback<evaluateString>),
+        method("evaluateColumns", callback<evaluateColumns>),
+        method("release", callback<bound<&LaminaInterpreter::release>>),
+        method("getLastError", callback<bound<&LaminaInterpreter::getLastError>>),
+        method("setLimits", callback<bound<&LaminaInterpreter::setLimits>>),
+        method("lastStepCount", callback<bound<&LaminaInterpreter::lastStepCount>>),
+        method("setMemoryQuota", callback<bound<&LaminaInterpreter::setMemoryQuota>>),
+        method("memoryUsage", callback<memoryUsage>),
+        method("setProfiling", callback<bound<&LaminaInterpreter::setProfiling>>),
+        method("getProfile", callback<getProfile>),
+        method("resetProfile", callback<bound<&LaminaInterpreter::resetProfile>>),
+        method("setLineProfiling", callback<bound<&LaminaInterpreter::setLineProfiling>>),
+        method("getLineProfile", callback<getLineProfile>),
+        method("getCollapsedStacks", callback<bound<&LaminaInterpreter::getCollapsedStacks>>),
+        method("resetLineProfile", callback<bound<&LaminaInterpreter::resetLineProfile>>),
+        method("startTrace", callback<bound<&LaminaInterpreter::startTrace>>),
+        method("stopTrace", callback<bound<&LaminaInterpreter::stopTrace>>),
+        method("exportTrace", callback<bound<&LaminaInterpreter::exportTrace>>),
+        method("clearTrace", callback<bound<&LaminaInterpreter::clearTrace>>),
+        method("enableParseCache", callback<bound<&LaminaInterpreter::enableParseCache>>),
+        method("disableParseCache", callback<bound<&LaminaInterpreter::disableParseCache>>),
+        method("getParseCacheStats", callback<getParseCacheStats>),
+        method("setOutputCapture", callback<bound<&LaminaInterpreter::setOutputCapture>>),
+        method("takeOutput", callback<bound<&LaminaInterpreter::takeOutput>>),
+        method("outputView", callback<outputView>),
+        method("clearOutput", callback<bound<&LaminaInterpreter::clearOutput>>),
+        method("evalBatch", callback<evalBatch>),
+        method("setVariable", callback<bound<&LaminaInterpreter::setVariable>>),
+        method("setStringVariable", callback<bound<&LaminaInterpreter::setStringVariable>>),
+        method("bindVariables", callback<bindVariables>),
+        method("bindArray", callback<bindArray>),
+        method("getVariable", callback<bound<&LaminaInterpreter::getVariable>>),
+        method("getVariableValue", callback<getVariableValue>),
+        method("reset", callback<bound<&LaminaInterpreter::reset>>),
+        method("snapshot", callback<snapshot>),
+        method("restore", callback<restore>),
+        method("fork", callback<fork>),
+        method("delete", callback<interpreter_delete>),
+        static_method("getVersion", callback<getVersion>),
+    };
+    napi_value cls;
+    check(env, napi_define_class(env, "LaminaInterpreter", NAPI_AUTO_LENGTH, callback<interpreter_new>, nullptr,
+                                 std::size(methods), methods, &cls));
+    return cls;
+}
+
+napi_value define_snapshot(napi_env env) {
+    static const napi_property_descriptor methods[] = {
+        method("delete", callback<snapshot_delete>),
+    };
+    napi_value cls;
+    check(env, napi_define_class(env, "InterpreterSnapshot", NAPI_AUTO_LENGTH, callback<snapshot_new>, nullptr,
+                                 std::size(methods), methods, &cls));
+    return cls;
+}
+
+napi_value init(napi_env env, napi_value exports) {
+    try {
+        auto* data = new AddonData();
+        check(env, napi_set_instance_data(env, data, [](napi_env env, void* data, void*) {
+            auto* addon = static_cast<AddonData*>(data);
+            addon->heap.destroy(env);
+            napi_delete_reference(env, addon->interpreter_class);
+            napi_delete_reference(env, addon->snapshot_class);
+            delete addon;
+        }, nullptr));
+
+        napi_value interpreter_class = define_interpreter(env);
+        napi_value snapshot_class = define_snapshot(env);
+        check(env, napi_create_reference(env, interpreter_class, 1, &data->interpreter_class));
+        check(env, napi_create_reference(env, snapshot_class, 1, &data->snapshot_class));
+
+        const napi_property_descriptor properties[] = {
+            method("evaluateExpression", callback<evaluateExpression>),
+            method("evaluateExpressionValue", callback<evaluateExpressionValue>),
+            method("executeCode", callback<executeCode>),
+            method("setInterpreterPoolSize", callback<setInterpreterPoolSize>),
+            method("getInterpreterPoolStats", callback<getInterpreterPoolStats>),
+            method("warmUp", callback<warmUp>),
+            method("_malloc", callback<malloc_>),
+            method("_free", callback<free_>),
+            getter("HEAPU8", callback<heap_view<napi_uint8_array, 1>>),
+            getter("HEAPU32", callback<heap_view<napi_uint32_array, 4>>),
+            getter("HEAP32", callback<heap_view<napi_int32_array, 4>>),
+            getter("HEAPF64", callback<heap_view<napi_float64_array, 8>>),
+        };
+        check(env, napi_define_properties(env, exports, std::size(properties), properties));
+        check(env, napi_set_named_property(env, exports, "LaminaInterpreter", interpreter_class));
+        check(env, napi_set_named_property(env, exports, "InterpreterSnapshot", snapshot_class));
+        return exports;
+    } catch (const PendingException&) {
+    } catch (const std::exception& e) {
+        napi_throw_error(env, nullptr, e.what());
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, init)
@@ -0,0 +1,309 @@
+#pragma once
+
+#include "../Lamina/interpreter/ast.hpp"
+#include "../Lamina/interpreter/value.hpp"
+#include "parallel.hpp"
+#include "simd_kernels.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * Float64 kernel for columnar evaluation of a compiled expression
+ *
+ * Expressions built only from numeric literals, variables, arithmetic
+ * operators and pure math builtins are lowered into a flat postfix program.
+ * The program then runs over blocks of rows, one instruction at a time for
+ * the whole block, without creating any Value objects. Inputs the
+ * interpreter rejects (division by zero, sqrt of a negative number, log of
+ * a number that is not positive) are not given IEEE results; the run
+ * reports them so the caller can fall back to the interpreter, which raises
+ * the same error as elsewhere. A call is only lowered when it reaches the
+ * builtin, not a user function of the same name.
+ */
+class NumericKernel {
+public:
+    /**
+     * Resolves a non-column identifier to a numeric constant
+     * Returns false when the identifier is unknown or not numeric
+     */
+    using Resolver = std::function<bool(const std::string&, double&)>;
+
+    /**
+     * Whether a call of the given name reaches the builtin of that name,
+     * i.e. no user function shadows it
+     */
+    using BuiltinCheck = std::function<bool(const std::string&)>;
+
+    /**
+     * Lower an expression into a numeric kernel
+     * @param expr Expression to lower
+     * @param columns Names of the column variables, in column order
+     * @param resolve Resolver for identifiers that are not columns
+     * @param is_builtin Check for the callees of calls
+     * @return The kernel, or std::nullopt if the expression is not purely numeric
+     */
+    static std::optional<NumericKernel> compile(const Expression* expr,
+                                                const std::vector<std::string>& columns,
+                                                const Resolver& resolve, const BuiltinCheck& is_builtin) {
+        NumericKernel kernel;
+        if (!kernel.lower(expr, columns, resolve, is_builtin, 0)) {
+            return std::nullopt;
+        }
+        return kernel;
+    }
+
+    /**
+     * Evaluate the kernel for every row
+     * @param columns One pointer per column, each to rows float64 values
+     * @param rows Number of rows
+     * @param out Output buffer of rows float64 values
+     * @return False if some row divides by zero, takes the square root of
+     *         a negative number or the log of a number that is not
+     *         positive; out is then incomplete
+     */
+    bool run(const double* const* columns, size_t rows, double* out) const {
+        // Blocks are independent, so large inputs are split across threads
+        std::atomic<bool> rejected{false};
+        parallel_for((rows + BLOCK - 1) / BLOCK, MIN_PARALLEL_BLOCKS, [&](size_t first, size_t last) {
+            if (!run_rows(columns, first * BLOCK, std::min(rows, last * BLOCK), out, rejected)) {
+                rejected.store(true, std::memory_order_relaxed);
+            }
+        });
+        return !rejected.load();
+    }
+
+private:
+    static constexpr size_t BLOCK = 256;
+    static constexpr size_t MIN_PARALLEL_BLOCKS = 64;
+
+    using UnaryFn = double (*)(double);
+    using BinaryFn = double (*)(double, double);
+
+    enum class Op : uint8_t { Const, Column, Neg, Sqrt, Log, Add, Sub, Mul, Div, Mod, Pow, Call1, Call2 };
+
+    struct Instr {
+        Op op;
+        uint32_t index = 0;
+        double value = 0.0;
+        UnaryFn fn1 = nullptr;
+        BinaryFn fn2 = nullptr;
+    };
+
+    std::vector<Instr> program;
+    size_t max_depth = 0;
+
+    /**
+     * Evaluate rows [begin, end), one block at a time
+     * @param rejected Set by another thread that hit a rejected input
+     * @return False on a rejected input
+     */
+    bool run_rows(const double* const* columns, size_t begin, size_t end, double* out,
+                  const std::atomic<bool>& rejected) const {
+        std::vector<double> stack(max_depth * BLOCK);
+
+        for (size_t start = begin; start < end; start += BLOCK) {
+            if (rejected.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            const size_t n = std::min(BLOCK, end - start);
+            size_t sp = 0;
+
+            for (const auto& ins : program) {
+                switch (ins.op) {
+                case Op::Const: {
+                    double* dst = &stack[sp++ * BLOCK];
+                    std::fill(dst, dst + n, ins.value);
+                    break;
+                }
+                case Op::Column: {
+                    double* dst = &stack[sp++ * BLOCK];
+                    std::copy(columns[ins.index] + start, columns[ins.index] + start + n, dst);
+                    break;
+                }
+                case Op::Neg: {
+                    simd_neg(&stack[(sp - 1) * BLOCK], n);
+                    break;
+                }
+                case Op::Sqrt: {
+                    double* a = &stack[(sp - 1) * BLOCK];
+                    if (std::any_of(a, a + n, [](double x) { return x < 0; })) {
+                        return false;
+                    }
+                    for (size_t i = 0; i < n; ++i) a[i] = std::sqrt(a[i]);
+                    break;
+                }
+                case Op::Log: {
+                    double* a = &stack[(sp - 1) * BLOCK];
+                    if (std::any_of(a, a + n, [](double x) { return !(x > 0); })) {
+                        return false;
+                    }
+                    for (size_t i = 0; i < n; ++i) a[i] = std::log(a[i]);
+                    break;
+                }
+                case Op::Call1: {
+                    double* a = &stack[(sp - 1) * BLOCK];
+                    for (size_t i = 0; i < n; ++i) a[i] = ins.fn1(a[i]);
+                    break;
+                }
+                default: {
+                    const double* b = &stack[--sp * BLOCK];
+                    double* a = &stack[(sp - 1) * BLOCK];
+                    if ((ins.op == Op::Div || ins.op == Op::Mod)
+                        && std::any_of(b, b + n, [](double x) { return x == 0; })) {
+                        return false;
+                    }
+                    apply_binary(ins, a, b, n);
+                    break;
+                }
+                }
+            }
+
+            std::copy(stack.data(), stack.data() + n, out + start);
+        }
+        return true;
+    }
+
+    static void apply_binary(const Instr& ins, double* a, const double* b, size_t n) {
+        switch (ins.op) {
+        case Op::Add: simd_add(a, b, n); break;
+        case Op::Sub: simd_sub(a, b, n); break;
+        case Op::Mul: simd_mul(a, b, n); break;
+        case Op::Div: simd_div(a, b, n); break;
+        case Op::Mod: for (size_t i = 0; i < n; ++i) a[i] = std::fmod(a[i], b[i]); break;
+        case Op::Pow: for (size_t i = 0; i < n; ++i) a[i] = std::pow(a[i], b[i]); break;
+        case Op::Call2: for (size_t i = 0; i < n; ++i) a[i] = ins.fn2(a[i], b[i]); break;
+        default: break;
+        }
+    }
+
+    static UnaryFn unary_function(const std::string& name) {
+        if (name == "sin") return [](double x) { return std::sin(x); };
+        if (name == "cos") return [](double x) { return std::cos(x); };
+        if (name == "tan") return [](double x) { return std::tan(x); };
+        if (name == "exp") return [](double x) { return std::exp(x); };
+        if (name == "abs") return [](double x) { return std::fabs(x); };
+        if (name == "floor") return [](double x) { return std::floor(x); };
+        if (name == "ceil") return [](double x) { return std::ceil(x); };
+        return nullptr;
+    }
+
+    static BinaryFn binary_function(const std::string& name) {
+        if (name == "pow") return [](double x, double y) { return std::pow(x, y); };
+        return nullptr;
+    }
+
+    static bool binary_op(const std::string& op, Op& out) {
+        if (op == "+") out = Op::Add;
+        else if (op == "-") out = Op::Sub;
+        else if (op == "*") out = Op::Mul;
+        else if (op == "/") out = Op::Div;
+        else if (op == "%") out = Op::Mod;
+        else if (op == "^") out = Op::Pow;
+        else return false;
+        return true;
+    }
+
+    /**
+     * Append the postfix program of an expression
+     * @param depth Stack depth before the expression pushes its result
+     */
+    bool lower(const Expression* expr, const std::vector<std::string>& columns,
+               const Resolver& resolve, const BuiltinCheck& is_builtin, size_t depth) {
+        auto push = [&](Instr ins) {
+            program.push_back(ins);
+            max_depth = std::max(max_depth, depth + 1);
+            return true;
+        };
+
+        if (auto* literal = dynamic_cast<const LiteralExpr*>(expr)) {
+            if (literal->type != Value::Type::Int && literal->type != Value::Type::Float) {
+                return false;
+            }
+            try {
+                return push({Op::Const, 0, std::stod(literal->value)});
+            } catch (...) {
+                return false;
+            }
+        }
+
+        if (auto* identifier = dynamic_cast<const IdentifierExpr*>(expr)) {
+            for (size_t i = 0; i < columns.size(); ++i) {
+                if (columns[i] == identifier->name) {
+                    return push({Op::Column, static_cast<uint32_t>(i)});
+                }
+            }
+            double constant = 0.0;
+            if (resolve(identifier->name, constant)) {
+                return push({Op::Const, 0, constant});
+            }
+            return false;
+        }
+
+        if (auto* unary = dynamic_cast<const UnaryExpr*>(expr)) {
+            if (unary->op != "-" && unary->op != "+") {
+                return false;
+            }
+            if (!lower(unary->operand.get(), columns, resolve, is_builtin, depth)) {
+                return false;
+            }
+            if (unary->op == "-") {
+                program.push_back({Op::Neg});
+            }
+            return true;
+        }
+
+        if (auto* binary = dynamic_cast<const BinaryExpr*>(expr)) {
+            Op op;
+            if (!binary_op(binary->op, op)
+                || !lower(binary->left.get(), columns, resolve, is_builtin, depth)
+                || !lower(binary->right.get(), columns, resolve, is_builtin, depth + 1)) {
+                return false;
+            }
+            program.push_back({op});
+            return true;
+        }
+
+        if (auto* call = dynamic_cast<const CallExpr*>(expr)) {
+            if (!is_builtin(call->callee)) {
+                return false;
+            }
+            if (call->args.size() == 1 && (call->callee == "sqrt" || call->callee == "log")) {
+                if (!lower(call->args[0].get(), columns, resolve, is_builtin, depth)) {
+                    return false;
+                }
+                program.push_back({call->callee == "sqrt" ? Op::Sqrt : Op::Log});
+                return true;
+            }
+            if (call->args.size() == 1) {
+                UnaryFn fn = unary_function(call->callee);
+                if (!fn || !lower(call->args[0].get(), columns, resolve, is_builtin, depth)) {
+                    return false;
+                }
+                Instr ins{Op::Call1};
+                ins.fn1 = fn;
+                program.push_back(ins);
+                return true;
+            }
+            if (call->args.size() == 2) {
+                BinaryFn fn = binary_function(call->callee);
+                if (!fn
+                    || !lower(call->args[0].get(), columns, resolve, is_builtin, depth)
+                    || !lower(call->args[1].get(), columns, resolve, is_builtin, depth + 1)) {
+                    return false;
+                }
+                Instr ins{Op::Call2};
+                ins.fn2 = fn;
+                program.push_back(ins);
+                return true;
+            }
+        }
+
+        return false;
+    }
+};
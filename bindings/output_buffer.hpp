@@ -0,0 +1,87 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+/**
+ * Growable output buffer for print()
+ *
+ * In pass-through mode output is written to std::cout in bulk, either when
+ * the buffer grows past FLUSH_THRESHOLD or when the current call returns.
+ * In capture mode output stays in the buffer until JavaScript drains it.
+ */
+class OutputBuffer {
+public:
+    static constexpr size_t FLUSH_THRESHOLD = 64 * 1024;
+
+    /**
+     * Flushes the buffer when the enclosing call returns
+     */
+    class Flush {
+    public:
+        explicit Flush(OutputBuffer& output) : output(output) {}
+        ~Flush() { output.flush(); }
+
+        Flush(const Flush&) = delete;
+        Flush& operator=(const Flush&) = delete;
+
+    private:
+        OutputBuffer& output;
+    };
+
+    void append(const std::string& text) {
+        data += text;
+    }
+
+    void append(char c) {
+        data += c;
+    }
+
+    /**
+     * Flush to std::cout if the buffer is under pressure
+     */
+    void maybe_flush() {
+        if (data.size() >= FLUSH_THRESHOLD) {
+            flush();
+        }
+    }
+
+    /**
+     * Write buffered output to std::cout, unless capturing
+     */
+    void flush() {
+        if (capture || data.empty()) {
+            return;
+        }
+        std::cout.write(data.data(), static_cast<std::streamsize>(data.size()));
+        std::cout.flush();
+        data.clear();
+    }
+
+    void set_capture(bool enabled) {
+        capture = enabled;
+        flush();
+    }
+
+    bool capturing() const {
+        return capture;
+    }
+
+    const std::string& contents() const {
+        return data;
+    }
+
+    std::string take() {
+        std::string result;
+        result.swap(data);
+        return result;
+    }
+
+    void clear() {
+        data.clear();
+    }
+
+private:
+    std::string data;
+    bool capture = false;
+};
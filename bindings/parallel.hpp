@@ -0,0 +1,187 @@
+#pragma once
+
+#include "memory_accounting.hpp"
+#include "trace_recorder.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+
+#ifdef LAMINA_THREADS
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#endif
+
+/**
+ * Data-parallel loops for the numeric kernels
+ *
+ * Builds defining LAMINA_THREADS (the pthreads WASM module and the Node-API
+ * addon) split a loop across up to that many threads, the calling thread
+ * included; other builds run it inline. The other threads belong to a pool
+ * started on the first parallel loop and kept for the life of the process,
+ * so a kernel that runs many short loops, such as det's elimination steps,
+ * does not start a thread per loop. Under Emscripten the pool takes the
+ * pre-started pthreads (PTHREAD_POOL_SIZE = LAMINA_THREADS - 1).
+ *
+ * Loop bodies run without a current MemoryAccount or TraceRecorder, on
+ * every thread, so what they allocate is not charged to the script. If a
+ * chunk throws, the first exception is rethrown on the calling thread once
+ * every chunk has finished.
+ */
+
+/**
+ * Number of threads a parallel loop may use, 1 when built without threads
+ */
+inline size_t parallel_threads() {
+#ifdef LAMINA_THREADS
+    static const size_t count =
+        std::clamp<size_t>(std::thread::hardware_concurrency(), 1, LAMINA_THREADS);
+    return count;
+#else
+    return 1;
+#endif
+}
+
+#ifdef LAMINA_THREADS
+
+namespace parallel_detail {
+
+/**
+ * The chunks of one parallel loop
+ * Chunks are claimed by index, by the caller as well as by any worker that
+ * picks the job up, so the caller never waits for a busy pool to start one
+ */
+struct Job {
+    using Invoke = void (*)(const void* body, size_t begin, size_t end);
+
+    Invoke invoke;
+    const void* body;
+    size_t n;
+    size_t chunk;
+    size_t count;
+
+    std::atomic<size_t> next{0};
+    std::mutex mutex;
+    std::condition_variable finished;
+    size_t done = 0;
+    std::exception_ptr error;
+
+    Job(Invoke invoke, const void* body, size_t n, size_t chunk)
+        : invoke(invoke), body(body), n(n), chunk(chunk), count((n + chunk - 1) / chunk) {}
+
+    /**
+     * Run chunks until none are left to claim
+     * Does not touch body once every chunk is claimed, so a worker may
+     * reach a job after its loop has returned
+     */
+    void work() {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            std::exception_ptr failure;
+            try {
+                invoke(body, i * chunk, std::min(n, (i + 1) * chunk));
+            } catch (...) {
+                failure = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (failure && !error) {
+                error = failure;
+            }
+            if (++done == count) {
+                finished.notify_all();
+            }
+        }
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return done == count; });
+    }
+};
+
+/**
+ * Workers shared by every parallel loop in the process
+ */
+class WorkerPool {
+public:
+    static WorkerPool& instance() {
+        // Never destroyed: the workers wait for jobs until the process exits
+        static WorkerPool* pool = new WorkerPool(parallel_threads() - 1);
+        return *pool;
+    }
+
+    /**
+     * Offer a job to up to helpers idle workers
+     */
+    void submit(const std::shared_ptr<Job>& job, size_t helpers) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = 0; i < helpers; ++i) {
+                queue.push_back(job);
+            }
+        }
+        ready.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::shared_ptr<Job>> queue;
+
+    explicit WorkerPool(size_t threads) {
+        for (size_t i = 0; i < threads; ++i) {
+            std::thread([this] { loop(); }).detach();
+        }
+    }
+
+    void loop() {
+        for (;;) {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this] { return !queue.empty(); });
+                job = std::move(queue.front());
+                queue.pop_front();
+            }
+            job->work();
+        }
+    }
+};
+
+} // namespace parallel_detail
+
+#endif
+
+/**
+ * Run body(begin, end) over contiguous chunks covering [0, n)
+ * @param min_chunk Smallest chunk worth a thread of its own
+ */
+template <typename Body>
+void parallel_for(size_t n, size_t min_chunk, const Body& body) {
+    size_t threads = std::min(parallel_threads(), n / std::max<size_t>(min_chunk, 1));
+    if (threads <= 1) {
+        if (n > 0) {
+            body(size_t(0), n);
+        }
+        return;
+    }
+
+#ifdef LAMINA_THREADS
+    // Same conditions as on the workers, for the chunks the caller runs
+    MemoryAccount::Scope pause(nullptr);
+    TraceRecorder::Scope untraced(nullptr);
+
+    auto invoke = [](const void* target, size_t begin, size_t end) {
+        (*static_cast<const Body*>(target))(begin, end);
+    };
+    auto job = std::make_shared<parallel_detail::Job>(invoke, &body, n, (n + threads - 1) / threads);
+    parallel_detail::WorkerPool::instance().submit(job, job->count - 1);
+    job->work();
+    job->wait();
+    if (job->error) {
+        std::rethrow_exception(job->error);
+    }
+#endif
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "../Lamina/interpreter/ast.hpp"
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+/**
+ * LRU cache of parsed programs, keyed by a hash of the source text
+ *
+ * Entries keep the source so that hash collisions are detected. The byte
+ * budget counts the source plus an estimate of the AST size, since the
+ * parser's own allocations are not visible from here.
+ */
+class ParseCache {
+public:
+    // Rough AST size per byte of source text
+    static constexpr size_t AST_BYTES_PER_SOURCE_BYTE = 8;
+
+    /**
+     * Set the cache budget; a zero entry budget disables the cache
+     * Shrinking the budget evicts entries immediately
+     */
+    void configure(size_t max_entries, size_t max_bytes) {
+        entry_budget = max_entries;
+        byte_budget = max_bytes;
+        evict(0);
+    }
+
+    bool enabled() const {
+        return entry_budget > 0;
+    }
+
+    /**
+     * Look up a program and mark it most recently used
+     * @return The cached AST, or nullptr on a miss
+     */
+    const std::unique_ptr<Statement>* find(const std::string& source) {
+        if (!enabled()) {
+            return nullptr;
+        }
+        auto it = index.find(std::hash<std::string>{}(source));
+        if (it == index.end() || it->second->source != source) {
+            ++miss_count;
+            return nullptr;
+        }
+        ++hit_count;
+        entries.splice(entries.begin(), entries, it->second);
+        return &it->second->ast;
+    }
+
+    /**
+     * Cache a freshly parsed program
+     * Ownership of ast is taken only if the entry fits in the budget
+     * @return The cached AST, or nullptr if it was not retained
+     */
+    const std::unique_ptr<Statement>* insert(const std::string& source, std::unique_ptr<Statement>& ast) {
+        size_t bytes = entry_size(source);
+        if (!enabled() || bytes > byte_budget) {
+            return nullptr;
+        }
+
+        size_t hash = std::hash<std::string>{}(source);
+        auto existing = index.find(hash);
+        if (existing != index.end()) {
+            remove(existing->second);
+        }
+
+        evict(bytes);
+        entries.push_front(Entry{hash, source, std::move(ast), bytes});
+        index[hash] = entries.begin();
+        byte_count += bytes;
+        return &entries.front().ast;
+    }
+
+    /**
+     * Call fn on every cached program, e.g. to instrument it in place
+     */
+    template <typename Fn>
+    void for_each(Fn&& fn) {
+        for (auto& entry : entries) {
+            fn(entry.ast);
+        }
+    }
+
+    void clear() {
+        entries.clear();
+        index.clear();
+        byte_count = 0;
+    }
+
+    uint64_t hits() const { return hit_count; }
+    uint64_t misses() const { return miss_count; }
+    size_t size() const { return entries.size(); }
+    size_t bytes() const { return byte_count; }
+    size_t max_entries() const { return entry_budget; }
+    size_t max_bytes() const { return byte_budget; }
+
+private:
+    struct Entry {
+        size_t hash;
+        std::string source;
+        std::unique_ptr<Statement> ast;
+        size_t bytes;
+    };
+
+    std::list<Entry> entries;  // Most recently used first
+    std::unordered_map<size_t, std::list<Entry>::iterator> index;
+    size_t entry_budget = 0;
+    size_t byte_budget = 0;
+    size_t byte_count = 0;
+    uint64_t hit_count = 0;
+    uint64_t miss_count = 0;
+
+    static size_t entry_size(const std::string& source) {
+        return sizeof(Entry) + source.size() * (1 + AST_BYTES_PER_SOURCE_BYTE);
+    }
+
+    void remove(std::list<Entry>::iterator it) {
+        byte_count -= it->bytes;
+        index.erase(it->hash);
+        entries.erase(it);
+    }
+
+    /**
+     * Evict least recently used entries until an entry of the given size fits
+     */
+    void evict(size_t incoming) {
+        while (!entries.empty()
+               && (entries.size() + (incoming ? 1 : 0) > entry_budget
+                   || byte_count + incoming > byte_budget)) {
+            remove(std::prev(entries.end()));
+        }
+    }
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
+/**
+ * Float64 loops behind the numeric fast paths
+ *
+ * In the SIMD build (-msimd128, lib/lamina-simd.js) these work on two
+ * lanes per instruction; elsewhere they are plain loops left to the
+ * compiler. Reductions keep two accumulators, so sums may round
+ * differently from a left-to-right loop in the last bit.
+ */
+
+constexpr bool SIMD_ENABLED =
+#ifdef __wasm_simd128__
+    true;
+#else
+    false;
+#endif
+
+/**
+ * Sum of a[i] * b[i]
+ */
+inline double simd_dot(const double* a, const double* b, size_t n) {
+    size_t i = 0;
+    double sum = 0.0;
+#ifdef __wasm_simd128__
+    v128_t acc0 = wasm_f64x2_splat(0.0);
+    v128_t acc1 = wasm_f64x2_splat(0.0);
+    for (; i + 4 <= n; i += 4) {
+        acc0 = wasm_f64x2_add(acc0, wasm_f64x2_mul(wasm_v128_load(a + i), wasm_v128_load(b + i)));
+        acc1 = wasm_f64x2_add(acc1, wasm_f64x2_mul(wasm_v128_load(a + i + 2), wasm_v128_load(b + i + 2)));
+    }
+    v128_t acc = wasm_f64x2_add(acc0, acc1);
+    sum = wasm_f64x2_extract_lane(acc, 0) + wasm_f64x2_extract_lane(acc, 1);
+#endif
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+/**
+ * y[i] -= factor * x[i]
+ */
+inline void simd_sub_scaled(double* y, double factor, const double* x, size_t n) {
+    size_t i = 0;
+#ifdef __wasm_simd128__
+    v128_t f = wasm_f64x2_splat(factor);
+    for (; i + 2 <= n; i += 2) {
+        wasm_v128_store(y + i, wasm_f64x2_sub(wasm_v128_load(y + i), wasm_f64x2_mul(f, wasm_v128_load(x + i))));
+    }
+#endif
+    for (; i < n; ++i) {
+        y[i] -= factor * x[i];
+    }
+}
+
+#ifdef __wasm_simd128__
+#define LAMINA_SIMD_BINARY(name, op, simd_op)                                   \
+    inline void name(double* a, const double* b, size_t n) {                   \
+        size_t i = 0;                                                          \
+        for (; i + 2 <= n; i += 2) {                                           \
+            wasm_v128_store(a + i, simd_op(wasm_v128_load(a + i), wasm_v128_load(b + i))); \
+        }                                                                      \
+        for (; i < n; ++i) {                                                   \
+            a[i] = a[i] op b[i];                                               \
+        }                                                                      \
+    }
+#else
+#define LAMINA_SIMD_BINARY(name, op, simd_op)                                   \
+    inline void name(double* a, const double* b, size_t n) {                   \
+        for (size_t i = 0; i < n; ++i) {                                       \
+            a[i] = a[i] op b[i];                                               \
+        }                                                                      \
+    }
+#endif
+
+// a[i] = a[i] <op> b[i]
+LAMINA_SIMD_BINARY(simd_add, +, wasm_f64x2_add)
+LAMINA_SIMD_BINARY(simd_sub, -, wasm_f64x2_sub)
+LAMINA_SIMD_BINARY(simd_mul, *, wasm_f64x2_mul)
+LAMINA_SIMD_BINARY(simd_div, /, wasm_f64x2_div)
+
+#undef LAMINA_SIMD_BINARY
+
+/**
+ * a[i] = -a[i]
+ */
+inline void simd_neg(double* a, size_t n) {
+    size_t i = 0;
+#ifdef __wasm_simd128__
+    for (; i + 2 <= n; i += 2) {
+        wasm_v128_store(a + i, wasm_f64x2_neg(wasm_v128_load(a + i)));
+    }
+#endif
+    for (; i < n; ++i) {
+        a[i] = -a[i];
+    }
+}
@@ -0,0 +1,217 @@
+#pragma once
+
+#include "clock.hpp"
+#include "memory_accounting.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * In-memory trace of interpreter activity in Chrome Trace Event format
+ *
+ * Events go into a fixed-size ring buffer, so a long run keeps its most
+ * recent history. A recorder is made current for the duration of a call
+ * (see Scope), which lets TraceSpan be used from free functions such as
+ * the parse helpers; with no current recorder a span costs one branch.
+ * Timestamps come from now_ms(), i.e. performance.now() under Emscripten,
+ * so they line up with spans recorded on the JavaScript side.
+ */
+class TraceRecorder {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 65536;
+
+    /**
+     * Makes a recorder current for the calling thread while in scope
+     */
+    class Scope {
+    public:
+        explicit Scope(TraceRecorder& recorder) : previous(current_recorder()) {
+            current_recorder() = recorder.enabled() ? &recorder : nullptr;
+        }
+        // Leaves no recorder current, e.g. while a call is suspended
+        explicit Scope(std::nullptr_t) : previous(current_recorder()) {
+            current_recorder() = nullptr;
+        }
+        ~Scope() { current_recorder() = previous; }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        TraceRecorder* previous;
+    };
+
+    static TraceRecorder* current() {
+        return current_recorder();
+    }
+
+    bool enabled() const {
+        return active;
+    }
+
+    /**
+     * Start recording into a fresh buffer
+     * @param capacity Number of events kept
+     */
+    void start(size_t capacity) {
+        MemoryAccount::Scope pause(nullptr);
+        events.assign(capacity > 0 ? capacity : DEFAULT_CAPACITY, Event{});
+        head = 0;
+        count = 0;
+        dropped = 0;
+        open_functions.clear();
+        active = true;
+    }
+
+    void stop() {
+        active = false;
+    }
+
+    void clear() {
+        head = 0;
+        count = 0;
+        dropped = 0;
+    }
+
+    /**
+     * Record a span that started at start_ms and ends now
+     */
+    void complete(const char* category, std::string name, double start_ms) {
+        record(Event{category, std::move(name), start_ms, now_ms() - start_ms});
+    }
+
+    /**
+     * A user function body is about to run
+     */
+    void function_enter(const std::string& name) {
+        MemoryAccount::Scope pause(nullptr);
+        open_functions.emplace_back(name, now_ms());
+    }
+
+    /**
+     * A user function call returned
+     */
+    void function_leave() {
+        if (open_functions.empty()) {
+            return;
+        }
+        auto [name, start] = std::move(open_functions.back());
+        open_functions.pop_back();
+        complete("function", std::move(name), start);
+    }
+
+    /**
+     * Close function spans left open by a call that threw
+     */
+    void close_functions() {
+        while (!open_functions.empty()) {
+            function_leave();
+        }
+    }
+
+    /**
+     * Export the buffer, oldest event first
+     * @return {"traceEvents": [...], ...} with timestamps in microseconds
+     */
+    std::string to_json() const {
+        MemoryAccount::Scope pause(nullptr);
+        std::string json = "{\"traceEvents\":[";
+        json += "{\"ph\":\"M\",\"pid\":1,\"tid\":1,\"name\":\"thread_name\",\"args\":{\"name\":\"lamina (wasm)\"}}";
+
+        size_t first = (head + events.size() - count) % (events.empty() ? 1 : events.size());
+        char number[64];
+        for (size_t i = 0; i < count; ++i) {
+            const Event& event = events[(first + i) % events.size()];
+            json += ",{\"ph\":\"X\",\"cat\":\"";
+            json += event.category;
+            json += "\",\"name\":\"";
+            append_escaped(json, event.name);
+            std::snprintf(number, sizeof(number), "\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                          event.start_ms * 1000, event.duration_ms * 1000);
+            json += number;
+        }
+
+        json += "],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":";
+        json += std::to_string(dropped);
+        json += "}}";
+        return json;
+    }
+
+private:
+    // A complete ("X") event
+    struct Event {
+        const char* category = "";
+        std::string name;
+        double start_ms = 0;
+        double duration_ms = 0;
+    };
+
+    bool active = false;
+    std::vector<Event> events;
+    size_t head = 0;   // Next slot to write
+    size_t count = 0;  // Valid events, at most events.size()
+    uint64_t dropped = 0;
+    std::vector<std::pair<std::string, double>> open_functions;
+
+    static TraceRecorder*& current_recorder() {
+        static thread_local TraceRecorder* recorder = nullptr;
+        return recorder;
+    }
+
+    void record(Event event) {
+        if (!active || events.empty()) {
+            return;
+        }
+        MemoryAccount::Scope pause(nullptr);
+        events[head] = std::move(event);
+        head = (head + 1) % events.size();
+        if (count < events.size()) {
+            ++count;
+        } else {
+            ++dropped;
+        }
+    }
+
+    static void append_escaped(std::string& out, const std::string& text) {
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char escape[8];
+                std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+                out += escape;
+            } else {
+                out += c;
+            }
+        }
+    }
+};
+
+/**
+ * Records a span on the current recorder, if any, when it goes out of scope
+ */
+class TraceSpan {
+public:
+    TraceSpan(const char* category, const char* name)
+        : recorder(TraceRecorder::current()), category(category), name(name),
+          start(recorder ? now_ms() : 0) {}
+
+    ~TraceSpan() {
+        if (recorder) {
+            recorder->complete(category, name, start);
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    TraceRecorder* recorder;
+    const char* category;
+    const char* name;
+    double start;
+};
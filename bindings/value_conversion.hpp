@@ -0,0 +1,117 @@
+#pragma once
+
+#include "../Lamina/interpreter/value.hpp"
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+/**
+ * Mapping of Lamina values onto JavaScript values, shared by the bindings
+ *
+ * convert_value() decides which JS shape a value takes and hands the parts
+ * to a builder, which only constructs the objects:
+ * - null, bool, int, float and string map to their JS counterparts
+ * - bigint maps to BigInt, rational to {type: "rational", num, den}
+ * - numeric arrays and matrices map to {type, data: Float64Array, shape}
+ * - irrational and symbolic values map to {type: "symbolic", text, approx}
+ * - other arrays map to JS arrays, anything else to {type: "other", text}
+ *
+ * A builder defines a Result type and the members
+ *   null(), boolean(bool), integer(int), number(double),
+ *   string(const std::string&), bigint(const ::BigInt&),
+ *   rational(const ::BigInt& num, const ::BigInt& den),
+ *   tensor(const char* type, const std::vector<double>& data,
+ *          std::initializer_list<size_t> shape),
+ *   array(size_t size), element(Result& array, size_t index, Result item),
+ *   symbolic(const std::string& text, double approx) and
+ *   other(const std::string& text)
+ */
+
+inline bool all_numeric(const std::vector<Value>& items) {
+    for (const auto& item : items) {
+        if (!item.is_numeric()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Builder>
+typename Builder::Result convert_value(const Value& value, Builder& builder) {
+    using Result = typename Builder::Result;
+
+    if (value.is_null()) {
+        return builder.null();
+    }
+    if (value.is_bool()) {
+        return builder.boolean(std::get<bool>(value.data));
+    }
+    if (value.is_int()) {
+        return builder.integer(std::get<int>(value.data));
+    }
+    if (value.is_float()) {
+        return builder.number(std::get<double>(value.data));
+    }
+    if (value.is_string()) {
+        return builder.string(std::get<std::string>(value.data));
+    }
+    if (value.is_bigint()) {
+        return builder.bigint(std::get<::BigInt>(value.data));
+    }
+    if (value.is_rational()) {
+        const auto& rational = std::get<::Rational>(value.data);
+        return builder.rational(rational.get_numerator(), rational.get_denominator());
+    }
+    if (value.is_array()) {
+        const auto& items = std::get<std::vector<Value>>(value.data);
+        if (all_numeric(items)) {
+            std::vector<double> data;
+            data.reserve(items.size());
+            for (const auto& item : items) {
+                data.push_back(item.as_number());
+            }
+            return builder.tensor("array", data, {data.size()});
+        }
+        Result result = builder.array(items.size());
+        for (size_t i = 0; i < items.size(); ++i) {
+            builder.element(result, i, convert_value(items[i], builder));
+        }
+        return result;
+    }
+    if (value.is_matrix()) {
+        const auto& rows = std::get<std::vector<std::vector<Value>>>(value.data);
+        size_t cols = rows.empty() ? 0 : rows[0].size();
+        std::vector<double> data;
+        data.reserve(rows.size() * cols);
+        for (const auto& row : rows) {
+            if (row.size() != cols || !all_numeric(row)) {
+                data.clear();
+                break;
+            }
+            for (const auto& item : row) {
+                data.push_back(item.as_number());
+            }
+        }
+        if (data.size() == rows.size() * cols) {
+            return builder.tensor("matrix", data, {rows.size(), cols});
+        }
+        Result result = builder.array(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i) {
+            builder.element(result, i, convert_value(Value(rows[i]), builder));
+        }
+        return result;
+    }
+
+    if (value.is_irrational() || value.is_symbolic()) {
+        double approx;
+        try {
+            approx = value.as_number();
+        } catch (...) {
+            approx = std::nan("");
+        }
+        return builder.symbolic(value.to_string(), approx);
+    }
+    return builder.other(value.to_string());
+}
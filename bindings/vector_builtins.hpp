@@ -0,0 +1,156 @@
+#pragma once
+
+#include "../Lamina/interpreter/interpreter.hpp"
+#include "../Lamina/interpreter/value.hpp"
+#include "parallel.hpp"
+#include "simd_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/**
+ * Float64 fast paths for the dot, norm and det builtins
+ *
+ * Each builtin is wrapped so that arguments made only of float values are
+ * computed on packed doubles (see simd_kernels.hpp) instead of Value by
+ * Value. Anything else, including integer and rational elements whose
+ * exact results must be kept, and malformed arguments that should produce
+ * the builtin's own error, goes to the original function.
+ */
+class VectorBuiltins {
+public:
+    using Builtin = decltype(std::declval<Interpreter&>().builtin_functions)::mapped_type;
+    using FastPath = std::optional<Value> (*)(const std::vector<Value>& args);
+
+    /**
+     * Wrapper installed in place of a builtin
+     */
+    struct FastBuiltin {
+        Builtin original;
+        FastPath fast;
+
+        Value operator()(const std::vector<Value>& args) const {
+            if (auto result = fast(args)) {
+                return std::move(*result);
+            }
+            return original(args);
+        }
+    };
+
+    /**
+     * Wrap the builtins of an interpreter; builtins that are missing or
+     * already wrapped are left alone
+     */
+    static void install(Interpreter& interpreter) {
+        wrap(interpreter, "dot", dot);
+        wrap(interpreter, "norm", norm);
+        wrap(interpreter, "det", det);
+    }
+
+private:
+    // Trailing-matrix elements per thread below which det() stays serial
+    static constexpr size_t MIN_PARALLEL_ELEMENTS = 32768;
+
+    static void wrap(Interpreter& interpreter, const char* name, FastPath fast) {
+        auto it = interpreter.builtin_functions.find(name);
+        if (it == interpreter.builtin_functions.end() || it->second.template target<FastBuiltin>()) {
+            return;
+        }
+        it->second = FastBuiltin{std::move(it->second), fast};
+    }
+
+    /**
+     * Copy the elements of a float array
+     * @return false unless value is an array of float values
+     */
+    static bool floats(const Value& value, std::vector<double>& out) {
+        if (!value.is_array()) {
+            return false;
+        }
+        const auto& items = std::get<std::vector<Value>>(value.data);
+        out.clear();
+        out.reserve(items.size());
+        for (const auto& item : items) {
+            if (!item.is_float()) {
+                return false;
+            }
+            out.push_back(std::get<double>(item.data));
+        }
+        return true;
+    }
+
+    static std::optional<Value> dot(const std::vector<Value>& args) {
+        std::vector<double> a, b;
+        if (args.size() != 2 || !floats(args[0], a) || !floats(args[1], b) || a.size() != b.size()) {
+            return std::nullopt;
+        }
+        return Value(simd_dot(a.data(), b.data(), a.size()));
+    }
+
+    static std::optional<Value> norm(const std::vector<Value>& args) {
+        std::vector<double> v;
+        if (args.size() != 1 || !floats(args[0], v)) {
+            return std::nullopt;
+        }
+        return Value(std::sqrt(simd_dot(v.data(), v.data(), v.size())));
+    }
+
+    /**
+     * Determinant by Gaussian elimination with partial pivoting
+     */
+    static std::optional<Value> det(const std::vector<Value>& args) {
+        if (args.size() != 1 || !args[0].is_matrix()) {
+            return std::nullopt;
+        }
+        const auto& rows = std::get<std::vector<std::vector<Value>>>(args[0].data);
+        const size_t n = rows.size();
+        if (n == 0) {
+            return std::nullopt;
+        }
+
+        std::vector<double> m;
+        m.reserve(n * n);
+        for (const auto& row : rows) {
+            if (row.size() != n) {
+                return std::nullopt;
+            }
+            for (const auto& item : row) {
+                if (!item.is_float()) {
+                    return std::nullopt;
+                }
+                m.push_back(std::get<double>(item.data));
+            }
+        }
+
+        double result = 1.0;
+        for (size_t col = 0; col < n; ++col) {
+            size_t pivot = col;
+            for (size_t r = col + 1; r < n; ++r) {
+                if (std::fabs(m[r * n + col]) > std::fabs(m[pivot * n + col])) {
+                    pivot = r;
+                }
+            }
+            if (m[pivot * n + col] == 0.0) {
+                return Value(0.0);
+            }
+            if (pivot != col) {
+                std::swap_ranges(&m[col * n], &m[col * n] + n, &m[pivot * n]);
+                result = -result;
+            }
+            const double* pivot_row = &m[col * n];
+            result *= pivot_row[col];
+            // Rows are eliminated independently; only split when each
+            // thread gets enough of the trailing matrix to pay for itself
+            const size_t width = n - col;
+            parallel_for(n - col - 1, std::max<size_t>(1, MIN_PARALLEL_ELEMENTS / width), [&](size_t first, size_t last) {
+                for (size_t r = col + 1 + first; r < col + 1 + last; ++r) {
+                    double* row = &m[r * n];
+                    simd_sub_scaled(row + col, row[col] / pivot_row[col], pivot_row + col, width);
+                }
+            });
+        }
+        return Value(result);
+    }
+};
@@ -1,211 +1,435 @@
 #include <emscripten/bind.h>
 #include <emscripten/val.h>
-#include "../Lamina/interpreter/interpreter.hpp"
-#include "../Lamina/interpreter/parser.hpp"
-#include "../Lamina/interpreter/lexer.hpp"
-#include "../Lamina/interpreter/value.hpp"
-#include <sstream>
+#include "lamina_interpreter.hpp"
+#include "value_conversion.hpp"
 #include <string>
 #include <memory>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
 
 using namespace emscripten;
 
-// Declare the print function from stdio.cpp
-inline Value print_wasm(const std::vector<Value>& args) {
-    for (size_t i = 0; i < args.size(); ++i) {
-        std::cout << args[i].to_string();
-        if (i != args.size() - 1) {
-            std::cout << " ";
+/**
+ * Builds the JS values chosen by convert_value()
+ */
+struct ValBuilder {
+    using Result = val;
+
+    val null() { return val::null(); }
+    val boolean(bool value) { return val(value); }
+    val integer(int value) { return val(value); }
+    val number(double value) { return val(value); }
+    val string(const std::string& value) { return val(value); }
+
+    val bigint(const ::BigInt& value) {
+        return val::global("BigInt")(value.to_string());
+    }
+
+    val rational(const ::BigInt& num, const ::BigInt& den) {
+        val result = val::object();
+        result.set("type", val("rational"));
+        result.set("num", bigint(num));
+        result.set("den", bigint(den));
+        return result;
+    }
+
+    val tensor(const char* type, const std::vector<double>& data, std::initializer_list<size_t> shape) {
+        val dims = val::array();
+        size_t i = 0;
+        for (size_t dim : shape) {
+            dims.set(i++, dim);
         }
+        val result = val::object();
+        result.set("type", val(type));
+        result.set("data", val::global("Float64Array").new_(typed_memory_view(data.size(), data.data())));
+        result.set("shape", dims);
+        return result;
+    }
+
+    val array(size_t) { return val::array(); }
+    void element(val& array, size_t index, val item) { array.set(index, item); }
+
+    val symbolic(const std::string& text, double approx) {
+        val result = val::object();
+        result.set("type", val("symbolic"));
+        result.set("text", val(text));
+        result.set("approx", val(approx));
+        return result;
+    }
+
+    val other(const std::string& text) {
+        val result = val::object();
+        result.set("type", val("other"));
+        result.set("text", val(text));
+        return result;
     }
-    std::cout << std::endl;
-    return Value();
+};
+
+/**
+ * Convert a Lamina value into a native JavaScript value
+ * See value_conversion.hpp for the mapping
+ */
+static val value_to_val(const Value& value) {
+    ValBuilder builder;
+    return convert_value(value, builder);
 }
 
 /**
- * LaminaInterpreter wrapper for JavaScript
- * Provides a simple interface to execute Lamina code from JavaScript/Node.js
+ * Build the {type: "error", message} object returned by typed entry points
  */
-class LaminaInterpreter {
-private:
-    std::unique_ptr<Interpreter> interpreter;
+static val error_to_val(const std::string& message) {
+    val result = val::object();
+    result.set("type", val("error"));
+    result.set("message", val(message));
+    return result;
+}
 
-public:
-    LaminaInterpreter() {
-        // Initialize interpreter with default settings
-        interpreter = std::make_unique<Interpreter>();
+// Methods of LaminaInterpreter that produce JS values or take WASM heap
+// addresses, bound as free functions taking the wrapper first
 
-        // Manually register print function for WebAssembly
-        // This bypasses the static initializer issue
-        interpreter->builtin_functions["print"] = [](const std::vector<Value>& args) -> Value {
-            return print_wasm(args);
-        };
-    }
+/**
+ * Take the result of the last successful evalStatus() as a JS value
+ */
+static val resultValue(LaminaInterpreter& self) {
+    return value_to_val(self.take_result());
+}
 
-    /**
-     * Execute Lamina code and return the result
-     * @param code The Lamina code to execute
-     * @return Result as a string
-     */
-    std::string execute(const std::string& code) {
-        try {
-            // Tokenize - static method
-            auto tokens = Lexer::tokenize(code);
-
-            // Parse - static method
-            auto ast = Parser::parse(tokens);
-
-            // Cast ASTNode to Statement (Parser::parse returns a BlockStmt which is a Statement)
-            auto stmt = std::unique_ptr<Statement>(static_cast<Statement*>(ast.release()));
-
-            // Execute
-            interpreter->execute(stmt);
-
-            return "";
-        } catch (const RuntimeError& e) {
-            std::string error_msg = std::string("RuntimeError: ") + e.what();
-            std::cerr << error_msg << std::endl;
-            return error_msg;
-        } catch (const StdLibException& e) {
-            std::string error_msg = std::string("StdLibException: ") + e.what();
-            std::cerr << error_msg << std::endl;
-            return error_msg;
-        } catch (const std::exception& e) {
-            std::string error_msg = std::string("std::exception: ") + e.what();
-            std::cerr << error_msg << std::endl;
-            return error_msg;
-        } catch (...) {
-            std::string error_msg = "Unknown C++ exception occurred during execution";
-            std::cerr << error_msg << std::endl;
-            return error_msg;
-        }
+/**
+ * Evaluate a Lamina expression through the status ABI in a single call
+ * @return The result as a string, or the ErrorKind of the failure as a
+ *         number (details via errorMessage() and errorOffset())
+ */
+static val evalString(LaminaInterpreter& self, const std::string& expression) {
+    int status = self.evalStatus(expression);
+    if (status != 0) {
+        return val(status);
     }
+    return val(self.resultString());
+}
 
-    /**
-     * Evaluate a Lamina expression and return the result
-     * @param expression The Lamina expression to evaluate
-     * @return Result as a string
-     */
-    std::string eval(const std::string& expression) {
-        try {
-            // Wrap the expression in a temporary variable assignment
-            // This allows us to get the result value
-            std::string code = "var __lamina_result__ = " + expression + ";";
-
-            // Tokenize - static method
-            auto tokens = Lexer::tokenize(code);
-
-            // Parse - static method
-            auto ast = Parser::parse(tokens);
-
-            // Cast ASTNode to Statement
-            auto stmt = std::unique_ptr<Statement>(static_cast<Statement*>(ast.release()));
-
-            // Execute the wrapped code
-            if (stmt) {
-                interpreter->execute(stmt);
-
-                // Get the result variable
-                try {
-                    Value result = interpreter->get_variable("__lamina_result__");
-                    return result.to_string();
-                } catch (...) {
-                    return "Error: Could not retrieve result";
-                }
-            }
-
-            return "null";
-        } catch (const RuntimeError& e) {
-            return std::string("RuntimeError: ") + e.what();
-        } catch (const std::exception& e) {
-            return std::string("Error: ") + e.what();
-        }
+/**
+ * Evaluate a compiled expression in a single call, see evalString()
+ */
+static val evaluateString(LaminaInterpreter& self, int handle) {
+    int status = self.evaluateStatus(handle);
+    if (status != 0) {
+        return val(status);
     }
+    return val(self.resultString());
+}
 
-    /**
-     * Set a variable in the interpreter
-     * @param name Variable name
-     * @param value Variable value (as string, will be evaluated)
-     */
-    void setVariable(const std::string& name, double value) {
-        try {
-            interpreter->set_variable(name, Value(value));
-        } catch (const std::exception& e) {
-            // Handle error silently or throw
-        }
+/**
+ * Evaluate a Lamina expression and return the result as a JS value
+ * See value_conversion.hpp for the mapping of Lamina types
+ * @return Result value, or a {type: "error", message} object
+ */
+static val evalValue(LaminaInterpreter& self, const std::string& expression) {
+    Value value;
+    std::string error;
+    if (!self.evaluate_value(expression, value, error)) {
+        return error_to_val(error);
     }
+    return value_to_val(value);
+}
 
-    /**
-     * Set a string variable in the interpreter
-     * @param name Variable name
-     * @param value Variable value as string
-     */
-    void setStringVariable(const std::string& name, const std::string& value) {
-        try {
-            interpreter->set_variable(name, Value(value));
-        } catch (const std::exception& e) {
-            // Handle error silently or throw
-        }
+/**
+ * Evaluate a compiled expression over columns in the WASM heap
+ * @param columns Heap address of columnCount uint32 column addresses
+ */
+static int evaluateColumns(LaminaInterpreter& self, int handle, uintptr_t names, uintptr_t nameOffsets,
+                           uintptr_t columns, size_t columnCount, size_t rows, uintptr_t out) {
+    const uint32_t* addresses = reinterpret_cast<const uint32_t*>(columns);
+    std::vector<const double*> data;
+    data.reserve(columnCount);
+    for (size_t i = 0; i < columnCount; ++i) {
+        data.push_back(reinterpret_cast<const double*>(addresses[i]));
     }
+    return self.evaluateColumns(handle, reinterpret_cast<const char*>(names),
+                                reinterpret_cast<const uint32_t*>(nameOffsets), data.data(), columnCount, rows,
+                                reinterpret_cast<double*>(out));
+}
+
+/**
+ * Get a Uint8Array view of the captured output
+ * The view aliases the buffer and is only valid until the next call
+ */
+static val outputView(const LaminaInterpreter& self) {
+    const std::string& data = self.captured_output();
+    return val(typed_memory_view(data.size(), reinterpret_cast<const uint8_t*>(data.data())));
+}
 
-    /**
-     * Get a variable from the interpreter
-     * @param name Variable name
-     * @return Variable value as string
-     */
-    std::string getVariable(const std::string& name) {
-        try {
-            Value val = interpreter->get_variable(name);
-            return val.to_string();
-        } catch (const std::exception& e) {
-            return std::string("Error: ") + e.what();
+/**
+ * Get heap usage charged to this interpreter
+ * @return {live, peak, quota} in bytes
+ */
+static val memoryUsage(const LaminaInterpreter& self) {
+    const MemoryAccount& memory = self.memory_account();
+    val usage = val::object();
+    usage.set("live", static_cast<double>(memory.live()));
+    usage.set("peak", static_cast<double>(memory.peak()));
+    usage.set("quota", static_cast<double>(memory.quota()));
+    return usage;
+}
+
+/**
+ * Get builtin call statistics, most expensive first
+ * @return Array of {name, calls, totalMs, selfMs, argTypes}, where
+ *         argTypes counts arguments by Lamina type
+ */
+static val getProfile(const LaminaInterpreter& self) {
+    auto rows = self.profile_rows();
+    val result = val::array();
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const auto& entry = *rows[i].second;
+        val arg_types = val::object();
+        for (size_t type = 0; type < BuiltinProfiler::ARG_TYPES.size(); ++type) {
+            if (entry.arg_types[type] > 0) {
+                arg_types.set(BuiltinProfiler::ARG_TYPES[type], static_cast<double>(entry.arg_types[type]));
+            }
         }
+        val row = val::object();
+        row.set("name", *rows[i].first);
+        row.set("calls", static_cast<double>(entry.calls));
+        row.set("totalMs", entry.total_ms);
+        row.set("selfMs", entry.self_ms);
+        row.set("argTypes", arg_types);
+        result.set(i, row);
     }
+    return result;
+}
 
-    /**
-     * Reset the interpreter state
-     */
-    void reset() {
-        // Create a new interpreter instance
-        interpreter = std::make_unique<Interpreter>();
+/**
+ * Get per-line statistics, most expensive first
+ * Lines count within the program numbered source, programs being
+ * numbered in the order they are first run while profiling
+ * @return Array of {source, line, function, hits, timeMs, allocations}
+ */
+static val getLineProfile(const LaminaInterpreter& self) {
+    auto rows = self.line_rows();
+    val result = val::array();
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const auto& site = *rows[i].first;
+        const auto& stats = *rows[i].second;
+        val row = val::object();
+        row.set("source", site.source);
+        row.set("line", site.line);
+        row.set("function", site.function.empty() ? std::string(LineProfiler::ROOT_FRAME) : site.function);
+        row.set("hits", static_cast<double>(stats.hits));
+        row.set("timeMs", stats.time_ms);
+        row.set("allocations", static_cast<double>(stats.allocations));
+        result.set(i, row);
     }
+    return result;
+}
+
+/**
+ * Get parse cache statistics
+ * @return {hits, misses, entries, bytes, maxEntries, maxBytes}
+ */
+static val getParseCacheStats(const LaminaInterpreter& self) {
+    const ParseCache& cache = self.program_cache();
+    val stats = val::object();
+    stats.set("hits", static_cast<double>(cache.hits()));
+    stats.set("misses", static_cast<double>(cache.misses()));
+    stats.set("entries", cache.size());
+    stats.set("bytes", cache.bytes());
+    stats.set("maxEntries", cache.max_entries());
+    stats.set("maxBytes", cache.max_bytes());
+    return stats;
+}
+
+/**
+ * Evaluate a batch of expressions packed in the WASM heap
+ * The returned views alias interpreter-owned memory and are only valid
+ * until the next call to evalBatch()
+ * @param source Heap address of the packed expression bytes
+ * @param offsets Heap address of count + 1 uint32 offsets into source
+ * @return Object with data, offsets and errors typed array views
+ */
+static val evalBatch(LaminaInterpreter& self, uintptr_t source, uintptr_t offsets, size_t count) {
+    const BatchResult& batch = self.evalBatch(reinterpret_cast<const char*>(source),
+                                              reinterpret_cast<const uint32_t*>(offsets), count);
+    val result = val::object();
+    result.set("data", val(typed_memory_view(batch.data.size(),
+        reinterpret_cast<const uint8_t*>(batch.data.data()))));
+    result.set("offsets", val(typed_memory_view(batch.offsets.size(), batch.offsets.data())));
+    result.set("errors", val(typed_memory_view(batch.errors.size(), batch.errors.data())));
+    return result;
+}
+
+/**
+ * Execute UTF-8 source in the WASM heap
+ */
+static int executeBytes(LaminaInterpreter& self, uintptr_t source, size_t length) {
+    return self.executeBytes(reinterpret_cast<const char*>(source), length);
+}
+
+/**
+ * Append a chunk of UTF-8 source in the WASM heap, see finishSource()
+ */
+static void appendSource(LaminaInterpreter& self, uintptr_t chunk, size_t length) {
+    self.appendSource(reinterpret_cast<const char*>(chunk), length);
+}
+
+/**
+ * Bind many numeric variables packed in the WASM heap
+ */
+static void bindVariables(LaminaInterpreter& self, uintptr_t names, uintptr_t nameOffsets, uintptr_t values,
+                          size_t count) {
+    self.bindVariables(reinterpret_cast<const char*>(names), reinterpret_cast<const uint32_t*>(nameOffsets),
+                       reinterpret_cast<const double*>(values), count);
+}
 
-    /**
-     * Get version information
-     */
-    static std::string getVersion() {
-        return "Lamina.js 1.0.0";
+/**
+ * Bind a numeric array variable from a typed array in the WASM heap
+ */
+static void bindArray(LaminaInterpreter& self, const std::string& name, uintptr_t data, size_t length,
+                      bool isInt) {
+    self.bindArray(name, reinterpret_cast<const void*>(data), length, isInt);
+}
+
+/**
+ * Get a variable from the interpreter as a JS value
+ * @return Variable value, or a {type: "error", message} object
+ */
+static val getVariableValue(const LaminaInterpreter& self, const std::string& name) {
+    Value value;
+    std::string error;
+    if (!self.variable_value(name, value, error)) {
+        return error_to_val(error);
     }
-};
+    return value_to_val(value);
+}
 
 /**
  * Standalone evaluate function for quick expressions
  */
 std::string evaluateExpression(const std::string& expression) {
-    LaminaInterpreter interp;
-    return interp.eval(expression);
+    auto interp = interpreter_pool().acquire();
+    return interp->eval(expression);
+}
+
+/**
+ * Standalone evaluate function returning a JS value
+ */
+val evaluateExpressionValue(const std::string& expression) {
+    auto interp = interpreter_pool().acquire();
+    return evalValue(*interp, expression);
 }
 
 /**
  * Standalone execute function for quick code execution
  */
 std::string executeCode(const std::string& code) {
-    LaminaInterpreter interp;
-    return interp.execute(code);
+    auto interp = interpreter_pool().acquire();
+    return interp->execute(code);
+}
+
+/**
+ * Set how many warm interpreters the standalone functions keep around
+ */
+void setInterpreterPoolSize(size_t size) {
+    interpreter_pool().set_capacity(size);
+}
+
+/**
+ * Get statistics of the standalone interpreter pool
+ * @return {capacity, idle, created, acquired, reused}
+ */
+val getInterpreterPoolStats() {
+    auto stats = interpreter_pool().stats();
+    val result = val::object();
+    result.set("capacity", stats.capacity);
+    result.set("idle", stats.idle);
+    result.set("created", static_cast<double>(stats.created));
+    result.set("acquired", static_cast<double>(stats.acquired));
+    result.set("reused", static_cast<double>(stats.acquired - stats.created));
+    return result;
+}
+
+/**
+ * Build the prototype interpreter ahead of the first context
+ * Called by the wrapper once the runtime is initialized, i.e. after every
+ * global constructor. It is not built from a global constructor itself:
+ * Lamina registers its builtins from static initializers in other
+ * translation units, and C++ leaves the order between them unspecified
+ */
+void warmUp() {
+    prototype_interpreter();
 }
 
 // Embind bindings
 EMSCRIPTEN_BINDINGS(lamina_module) {
+    class_<InterpreterSnapshot>("InterpreterSnapshot");
+
     class_<LaminaInterpreter>("LaminaInterpreter")
         .constructor<>()
         .function("execute", &LaminaInterpreter::execute)
         .function("eval", &LaminaInterpreter::eval)
+        .function("executeStatus", &LaminaInterpreter::executeStatus)
+        .function("evalStatus", &LaminaInterpreter::evalStatus)
+#ifdef LAMINA_JSPI
+        // Returns a Promise; the call suspends between slices
+        .function("executeAsync", &LaminaInterpreter::executeAsync, async())
+#endif
+        .function("lastYieldCount", &LaminaInterpreter::lastYieldCount)
+        .function("executeBytes", &executeBytes)
+        .function("appendSource", &appendSource)
+        .function("finishSource", &LaminaInterpreter::finishSource)
+        .function("discardSource", &LaminaInterpreter::discardSource)
+        .function("evalString", &evalString)
+        .function("resultString", &LaminaInterpreter::resultString)
+        .function("resultValue", &resultValue)
+        .function("errorKind", &LaminaInterpreter::errorKind)
+        .function("errorMessage", &LaminaInterpreter::errorMessage)
+        .function("errorOffset", &LaminaInterpreter::errorOffset)
+        .function("evalValue", &evalValue)
+        .function("compile", &LaminaInterpreter::compile)
+        .function("evaluate", &LaminaInterpreter::evaluate)
+        .function("evaluateString", &evaluateString)
+        .function("evaluateColumns", &evaluateColumns)
+        .function("release", &LaminaInterpreter::release)
+        .function("getLastError", &LaminaInterpreter::getLastError)
+        .function("setLimits", &LaminaInterpreter::setLimits)
+        .function("lastStepCount", &LaminaInterpreter::lastStepCount)
+        .function("setMemoryQuota", &LaminaInterpreter::setMemoryQuota)
+        .function("memoryUsage", &memoryUsage)
+        .function("setProfiling", &LaminaInterpreter::setProfiling)
+        .function("getProfile", &getProfile)
+        .function("resetProfile", &LaminaInterpreter::resetProfile)
+        .function("setLineProfiling", &LaminaInterpreter::setLineProfiling)
+        .function("getLineProfile", &getLineProfile)
+        .function("getCollapsedStacks", &LaminaInterpreter::getCollapsedStacks)
+        .function("resetLineProfile", &LaminaInterpreter::resetLineProfile)
+        .function("startTrace", &LaminaInterpreter::startTrace)
+        .function("stopTrace", &LaminaInterpreter::stopTrace)
+        .function("exportTrace", &LaminaInterpreter::exportTrace)
+        .function("clearTrace", &LaminaInterpreter::clearTrace)
+        .function("enableParseCache", &LaminaInterpreter::enableParseCache)
+        .function("disableParseCache", &LaminaInterpreter::disableParseCache)
+        .function("getParseCacheStats", &getParseCacheStats)
+        .function("setOutputCapture", &LaminaInterpreter::setOutputCapture)
+        .function("takeOutput", &LaminaInterpreter::takeOutput)
+        .function("outputView", &outputView)
+        .function("clearOutput", &LaminaInterpreter::clearOutput)
+        .function("evalBatch", &evalBatch)
         .function("setVariable", &LaminaInterpreter::setVariable)
         .function("setStringVariable", &LaminaInterpreter::setStringVariable)
+        .function("bindVariables", &bindVariables)
+        .function("bindArray", &bindArray)
         .function("getVariable", &LaminaInterpreter::getVariable)
+        .function("getVariableValue", &getVariableValue)
         .function("reset", &LaminaInterpreter::reset)
+        .function("snapshot", &LaminaInterpreter::snapshot)
+        .function("restore", &LaminaInterpreter::restore)
+        .function("fork", &LaminaInterpreter::fork)
         .class_function("getVersion", &LaminaInterpreter::getVersion);
 
     function("evaluateExpression", &evaluateExpression);
+    function("evaluateExpressionValue", &evaluateExpressionValue);
     function("executeCode", &executeCode);
+    function("setInterpreterPoolSize", &setInterpreterPoolSize);
+    function("getInterpreterPoolStats", &getInterpreterPoolStats);
+    function("warmUp", &warmUp);
 }
@@ -3,7 +3,7 @@
  * Run with: yarn test
  */
 
-import { lamina } from '../lib/index.mjs'
+import { lamina, LaminaError, LaminaPoolFullError } from '../lib/index.mjs'
 
 let passed = 0
 let failed = 0
@@ -91,6 +91,765 @@ async function runTests() {
     if (!result.includes('8')) throw new Error(`Expected 8, got ${result}`)
   })
 
+  // Test 9: Compiled expressions
+  await test('Compiled expression evaluation', async () => {
+    const expr = lamina.compile('p * q + 1')
+    lamina.set('p', 3).set('q', 4)
+    const first = expr.evaluate()
+    if (!first.includes('13')) throw new Error(`Expected 13, got ${first}`)
+    lamina.set('q', 10)
+    const second = expr.evaluate()
+    if (!second.includes('31')) throw new Error(`Expected 31, got ${second}`)
+    expr.release()
+    try {
+      lamina.compile('p * (')
+      throw new Error('Expected a compile error')
+    } catch (e) {
+      if (!(e instanceof LaminaError) || e.kind !== 'syntax') throw e
+    }
+  })
+
+  // Test 10: Batch evaluation
+  await test('Batch evaluation', async () => {
+    const { values, errors } = lamina.calcBatch(['1 + 1', '2 * 3', 'nope('])
+    if (!values[0].includes('2') || !values[1].includes('6')) {
+      throw new Error(`Unexpected batch values ${values}`)
+    }
+    if (errors[0] !== null || errors[2] === null) {
+      throw new Error(`Unexpected batch errors ${errors}`)
+    }
+  })
+
+  // Test 11: Typed results
+  await test('Typed result values', async () => {
+    const sum = lamina.calcValue('2 + 3')
+    if (sum !== 5) throw new Error(`Expected 5, got ${sum}`)
+    const ratio = lamina.calcValue('16 / 9')
+    if (ratio.type !== 'rational' || ratio.num !== 16n || ratio.den !== 9n) {
+      throw new Error(`Expected rational 16/9, got ${String(ratio.type)}`)
+    }
+    lamina.exec('var vec = [1, 2, 3];')
+    const vec = lamina.getValue('vec')
+    if (!(vec.data instanceof Float64Array) || vec.shape[0] !== 3) {
+      throw new Error('Expected a Float64Array of length 3')
+    }
+  })
+
+  // Test 12: Bulk variable binding
+  await test('Bulk variable binding', async () => {
+    lamina.bindVariables(['u', 'w'], new Float64Array([1.5, 2.5]))
+    const sum = lamina.calcValue('u + w')
+    if (sum !== 4) throw new Error(`Expected 4, got ${sum}`)
+    lamina.bindArray('ints', new Int32Array([1, 2, 3]))
+    const size = lamina.calcValue('size(ints)')
+    if (size !== 3) throw new Error(`Expected 3, got ${size}`)
+    const ints = lamina.getValue('ints')
+    if (Array.from(ints.data).join() !== '1,2,3') {
+      throw new Error(`Expected [1, 2, 3], got ${Array.from(ints.data)}`)
+    }
+    const detached = new Float64Array([1])
+    structuredClone(detached.buffer, { transfer: [detached.buffer] })
+    try {
+      lamina.bindArray('gone', detached)
+      throw new Error('Expected a detached array to be rejected')
+    } catch (e) {
+      if (!e.message.includes('detached')) throw e
+    }
+  })
+
+  // Test 13: Columnar evaluation
+  await test('Columnar evaluation', async () => {
+    const expr = lamina.compile('cx * 2 + cy')
+    const out = expr.evaluateColumns({
+      cx: new Float64Array([1, 2, 3]),
+      cy: new Float64Array([10, 20, 30])
+    })
+    expr.release()
+    if (Array.from(out).join() !== '12,24,36') {
+      throw new Error(`Unexpected columnar result ${Array.from(out)}`)
+    }
+    // Inputs the interpreter rejects fail as they do in calc()
+    for (const source of ['1 / cx', 'sqrt(cx)', 'log(cx)']) {
+      const rejected = lamina.compile(source)
+      try {
+        rejected.evaluateColumns({ cx: new Float64Array([1, 0, -1]) })
+        throw new Error(`Expected ${source} to fail`)
+      } catch (e) {
+        if (!(e instanceof LaminaError) || e.kind !== 'runtime') throw e
+      } finally {
+        rejected.release()
+      }
+    }
+
+    // The per-row path binds columns without touching the context's globals
+    const ctx = await lamina.createContext()
+    try {
+      ctx.define('func twice(n) { return n * 2; }').set('cx', 'kept')
+      const generic = ctx.compile('twice(cx) + cy')
+      const rowsOut = generic.evaluateColumns({
+        cx: new Float64Array([1, 2, 3]),
+        cy: new Float64Array([1, 1, 1])
+      })
+      generic.release()
+      if (Array.from(rowsOut).join() !== '3,5,7') {
+        throw new Error(`Unexpected per-row result ${Array.from(rowsOut)}`)
+      }
+      if (!ctx.get('cx').includes('kept')) {
+        throw new Error(`Column overwrote a global: ${ctx.get('cx')}`)
+      }
+      try {
+        ctx.get('cy')
+        throw new Error('Column left behind as a global')
+      } catch (e) {
+        if (!e.message.includes('not found')) throw e
+      }
+
+      // A user function shadowing a math builtin is called, as in calc()
+      ctx.define('func sin(x) { return 42; }')
+      const shadowed = ctx.compile('sin(cx)')
+      const sines = shadowed.evaluateColumns({ cx: new Float64Array([0, 1]) })
+      shadowed.release()
+      if (Array.from(sines).join() !== '42,42') {
+        throw new Error(`Shadowed builtin ignored: ${Array.from(sines)}`)
+      }
+    } finally {
+      ctx.destroy()
+    }
+  })
+
+  // Test 14: calc leaves no temporaries behind
+  await test('Expression evaluation has no side effects', async () => {
+    const ctx = await lamina.Context.create()
+    ctx.calc('1 + 1')
+    try {
+      ctx.get('__lamina_result__')
+      throw new Error('Expected no __lamina_result__ variable')
+    } catch (e) {
+      if (!e.message.includes('not found')) {
+        throw e
+      }
+    }
+    ctx.destroy()
+  })
+
+  // Test 15: Output capture
+  await test('Output capture', async () => {
+    const ctx = await lamina.Context.create()
+    ctx.captureOutput().exec('print("hello"); print(1 + 2);')
+    const output = ctx.takeOutput()
+    if (output !== 'hello\n3\n') {
+      throw new Error(`Unexpected output ${JSON.stringify(output)}`)
+    }
+    if (ctx.takeOutputBytes().length !== 0) {
+      throw new Error('Expected output buffer to be drained')
+    }
+    ctx.destroy()
+  })
+
+  // Test 16: Parse cache
+  await test('Parse cache', async () => {
+    const ctx = await lamina.Context.create()
+    ctx.enableParseCache({ maxEntries: 4 })
+    ctx.exec('var hits = 1;').exec('var hits = 1;')
+    const stats = ctx.parseCacheStats()
+    if (stats.hits !== 1 || stats.misses !== 1 || stats.entries !== 1) {
+      throw new Error(`Unexpected cache stats ${JSON.stringify(stats)}`)
+    }
+    ctx.destroy()
+  })
+
+  // Test 17: Snapshot and restore
+  await test('Snapshot and restore', async () => {
+    const ctx = await lamina.Context.create()
+    ctx.set('base', 1)
+    const snapshot = ctx.snapshot()
+    ctx.set('base', 2).set('extra', 3)
+    ctx.restore(snapshot)
+    snapshot.delete()
+    const base = ctx.get('base')
+    if (!base.includes('1')) throw new Error(`Expected 1, got ${base}`)
+    try {
+      ctx.get('extra')
+      throw new Error('Expected extra to be gone after restore')
+    } catch (e) {
+      if (!e.message.includes('not found')) {
+        throw e
+      }
+    }
+    ctx.captureOutput().reset().exec('print("after reset");')
+    if (ctx.takeOutput() !== 'after reset\n') {
+      throw new Error('Expected print to survive reset')
+    }
+    ctx.destroy()
+  })
+
+  // Test 18: Forked contexts
+  await test('Forked contexts', async () => {
+    const base = await lamina.Context.create()
+    base.define('func twice(n) { return n * 2; }')
+    const tenant = base.fork()
+    tenant.set('own', 21)
+    const result = tenant.calc('twice(own)')
+    if (!result.includes('42')) throw new Error(`Expected 42, got ${result}`)
+    try {
+      base.get('own')
+      throw new Error('Expected fork state to stay isolated')
+    } catch (e) {
+      if (!e.message.includes('not found')) {
+        throw e
+      }
+    }
+    tenant.destroy()
+    base.destroy()
+  })
+
+  // Test 19: Structured errors
+  await test('Structured errors', async () => {
+    // A result that reads like an error message is still a result
+    lamina.exec('var message = "Error: not really";')
+    const message = lamina.calc('message')
+    if (!message.includes('Error: not really')) {
+      throw new Error(`Unexpected value ${message}`)
+    }
+    if (message !== lamina.get('message')) {
+      throw new Error(`calc and get disagree: ${message}`)
+    }
+    try {
+      lamina.calc('1 +')
+      throw new Error('Expected a syntax error')
+    } catch (e) {
+      if (!(e instanceof LaminaError) || e.kind !== 'syntax') {
+        throw e
+      }
+      if (!e.detail || e.offset !== -1) {
+        throw new Error(`Unexpected error fields ${e.detail}, ${e.offset}`)
+      }
+    }
+  })
+
+  // Test 20: Execution limits
+  await test('Execution limits', async () => {
+    const ctx = await lamina.createContext()
+    try {
+      ctx.exec('var i = 0;')
+      // Defined before any limits were set
+      ctx.exec('func early() { while (true) { i = i + 1; } }')
+      try {
+        ctx.calc('early()', { maxSteps: 1000 })
+        throw new Error('Expected a limit error')
+      } catch (e) {
+        if (!(e instanceof LaminaError) || e.kind !== 'limit') {
+          throw e
+        }
+      }
+      try {
+        ctx.exec('while (true) { i = i + 1; }', { maxSteps: 1000 })
+        throw new Error('Expected a limit error')
+      } catch (e) {
+        if (!(e instanceof LaminaError) || e.kind !== 'limit') {
+          throw e
+        }
+      }
+      try {
+        ctx.exec('while (true) { i = i + 1; }', { timeoutMs: 20 })
+        throw new Error('Expected a limit error')
+      } catch (e) {
+        if (!(e instanceof LaminaError) || e.kind !== 'limit') {
+          throw e
+        }
+      }
+      // The context is still usable after an abort
+      if (ctx.calc('1 + 1') !== '2') {
+        throw new Error('Context unusable after limit')
+      }
+
+      // Every entry point that evaluates code runs under the budget
+      ctx.setLimits({ maxSteps: 1000 })
+      ctx.exec('func spin() { while (true) { i = i + 1; } }')
+      const spin = ctx.compile('spin() + cx')
+      const calls = {
+        calc: () => ctx.calc('spin()'),
+        evaluate: () => spin.evaluate(),
+        evaluateColumns: () =>
+          spin.evaluateColumns({ cx: new Float64Array([1, 2]) })
+      }
+      for (const [name, call] of Object.entries(calls)) {
+        try {
+          call()
+          throw new Error(`Expected a limit error from ${name}`)
+        } catch (e) {
+          if (!(e instanceof LaminaError) || e.kind !== 'limit') {
+            throw e
+          }
+        }
+      }
+      spin.release()
+      const { errors } = ctx.calcBatch(['spin()', '1 + 1'])
+      if (!errors[0]?.startsWith('LimitExceeded') || errors[1] !== null) {
+        throw new Error(`Unexpected batch errors ${errors}`)
+      }
+    } finally {
+      ctx.destroy()
+    }
+  })
+
+  // Test 21: Memory quota
+  await test('Memory quota', async () => {
+    const ctx = await lamina.createContext()
+    try {
+      if (lamina.backend === 'node') {
+        return // The native addon does not account memory
+      }
+      ctx.setMemoryQuota(64 * 1024)
+      ctx.exec('var small = 2 ^ 100;')
+      if (ctx.memoryUsage().live <= 0) {
+        throw new Error('Expected live memory to be accounted')
+      }
+      try {
+        ctx.exec('var n = 1; var i = 1; while (i < 100000) { n = n * i; i = i + 1; }')
+        throw new Error('Expected a memory error')
+      } catch (e) {
+        if (!(e instanceof LaminaError) || e.kind !== 'memory') {
+          throw e
+        }
+      }
+      const usage = ctx.memoryUsage()
+      // Unwinding may use up to 16 KiB over the quota
+      if (usage.peak > usage.quota + 16 * 1024) {
+        throw new Error(`Peak ${usage.peak} over quota ${usage.quota}`)
+      }
+      if (ctx.calc('1 + 1') !== '2') {
+        throw new Error('Context unusable after memory error')
+      }
+    } finally {
+      ctx.destroy()
+    }
+  })
+
+  // Test 22: Builtin profiler
+  await test('Builtin profiler', async () => {
+    const ctx = await lamina.createContext()
+    try {
+      ctx.profileBuiltins()
+      ctx.exec('var i = 0; while (i < 10) { var r = sqrt(i); i = i + 1; }')
+      const sqrt = ctx.builtinProfile().find((entry) => entry.name === 'sqrt')
+      if (!sqrt || sqrt.calls !== 10 || sqrt.argTypes.int !== 10) {
+        throw new Error(`Unexpected profile ${JSON.stringify(sqrt)}`)
+      }
+      ctx.profileBuiltins(false).resetBuiltinProfile()
+      ctx.exec('var s = sqrt(2);')
+      if (ctx.builtinProfile().length !== 0) {
+        throw new Error('Calls recorded while profiling was disabled')
+      }
+    } finally {
+      ctx.destroy()
+    }
+  })
+
+  // Test 23: Line profiler
+  await test('Line profiler', async () => {
+    const ctx = await lamina.createContext()
+    try {
+      ctx.profileLines()
+      ctx.exec(
+        [
+          'func square(n) {',
+          '  return n * n;',
+          '}',
+          'var i = 0;',
+          'while (i < 5) {',
+          '  var s = square(i);',
+          '  i = i + 1;',
+          '}'
+        ].join('\n')
+      )
+      const body = ctx
+        .lineProfile()
+        .find((entry) => entry.function === 'square' && entry.line === 2)
+      if (!body || body.hits !== 5) {
+        throw new Error(`Unexpected profile ${JSON.stringify(body)}`)
+      }
+      if (!ctx.collapsedStacks().includes('<main>;square')) {
+        throw new Error('Missing stack for square')
+      }
+
+      // Line 1 of two separate sources stays two entries
+      ctx.resetLineProfile()
+      ctx.exec('var a = 1;')
+      ctx.exec('var b = 2;')
+      const firstLines = ctx
+        .lineProfile()
+        .filter((entry) => entry.function === '<main>' && entry.line === 1)
+      const sources = new Set(firstLines.map((entry) => entry.source))
+      if (firstLines.length !== 2 || sources.size !== 2) {
+        throw new Error(`Sources merged ${JSON.stringify(firstLines)}`)
+      }
+    } finally {
+      ctx.destroy()
+    }
+  })
+
+  // Test 24: Trace export
+  await test('Trace export', async () => {
+    const ctx = await lamina.createContext()
+    try {
+      ctx.startTrace()
+      ctx.exec('func twice(n) { return n * 2; }\nvar x = twice(21);')
+      ctx.stopTrace()
+      ctx.exec('var y = twice(1);')
+
+      const { traceEvents } = JSON.parse(ctx.exportTrace())
+      const names = traceEvents
+        .filter((event) => event.ph === 'X')
+        .map((event) => `${event.cat}:${event.name}`)
+      for (const name of [
+        'js:execute',
+        'call:execute',
+        'phase:parse',
+        'function:twice'
+      ]) {
+        if (!names.includes(name)) {
+          throw new Error(`Missing ${name} in ${names.join(', ')}`)
+        }
+      }
+      if (names.filter((name) => name === 'js:execute').length !== 1) {
+        throw new Error('Recorded a call after stopTrace()')
+      }
+    } finally {
+      ctx.destroy()
+    }
+  })
+
+  // Test 25: Backend selection
+  await test('Backend selection', async () => {
+    const requested = process.env.LAMINA_BACKEND
+    const expected = requested
+      ? [requested]
+      : ['wasm', 'wasm-simd', 'node']
+    if (!expected.includes(lamina.backend)) {
+      throw new Error(`Unexpected backend: ${lamina.backend}`)
+    }
+    if (!lamina.calc('1/3 + 1/6').includes('1/2')) {
+      throw new Error(`Wrong result on ${lamina.backend} backend`)
+    }
+  })
+
+  // Test 26: Float vector builtins
+  await test('Float vector builtins', async () => {
+    const ctx = await lamina.createContext()
+    try {
+      ctx.exec('var u = [1.5, 2.5, 3.5]; var v = [2.0, 0.5, 1.0];')
+      ctx.exec('var m = [[2.0, 1.0], [4.0, 3.5]];')
+      const checks = [
+        ['dot(u, v)', 7.75],
+        ['norm(v)', Math.sqrt(5.25)],
+        ['det(m)', 3]
+      ]
+      for (const [expression, expected] of checks) {
+        const value = ctx.calcValue(expression)
+        if (Math.abs(value - expected) > 1e-12) {
+          throw new Error(`${expression}: expected ${expected}, got ${value}`)
+        }
+      }
+      // Integer arguments keep their exact result
+      if (ctx.calc('dot([1, 2, 3], [4, 5, 6])') !== '32') {
+        throw new Error('Exact dot product changed')
+      }
+    } finally {
+      ctx.destroy()
+    }
+  })
+
+  // Test 27: Columnar evaluation over many blocks
+  await test('Large columnar evaluation', async () => {
+    const rows = 100003
+    const cx = new Float64Array(rows).map((_, i) => i)
+    const expr = lamina.compile('cx * 3 - 1')
+    const out = expr.evaluateColumns({ cx })
+    expr.release()
+    for (let i = 0; i < rows; i++) {
+      if (out[i] !== i * 3 - 1) {
+        throw new Error(`Row ${i}: expected ${i * 3 - 1}, got ${out[i]}`)
+      }
+    }
+  })
+
+  // Test 28: Worker pool
+  await test('Worker pool', async () => {
+    const pool = await lamina.createPool({ size: 2, maxQueue: 4 })
+    try {
+      const [sum, product] = await Promise.all([
+        pool.calc('2 + 3'),
+        pool.calc('6 * 7')
+      ])
+      if (!sum.includes('5') || !product.includes('42')) {
+        throw new Error(`Unexpected results ${sum}, ${product}`)
+      }
+      const output = await pool.exec('var leaked = 1; print(leaked + 1);')
+      if (output.trim() !== '2') {
+        throw new Error(`Unexpected output ${JSON.stringify(output)}`)
+      }
+
+      const session = await pool.session()
+      await session.exec('var total = 40;')
+      await session.set('step', 2)
+      const total = await session.calc('total + step')
+      await session.close()
+      if (!total.includes('42')) {
+        throw new Error(`Session lost its state: ${total}`)
+      }
+
+      // Stateless exec starts from a fresh context every time
+      const leaked = await pool.calc('leaked').then(
+        () => true,
+        () => false
+      )
+      if (leaked) {
+        throw new Error('Variables leaked between exec calls')
+      }
+
+      // Two calls run, four wait, the rest are refused
+      const flood = await Promise.all(
+        Array.from({ length: 12 }, () =>
+          pool.calc('1 + 1').then(
+            () => null,
+            (e) => e
+          )
+        )
+      )
+      const refused = flood.filter((e) => e instanceof LaminaPoolFullError)
+      if (refused.length !== 6 || pool.stats().rejected !== 6) {
+        throw new Error(`Expected 6 refused calls, got ${refused.length}`)
+      }
+    } finally {
+      await pool.close()
+    }
+  })
+
+  // Test 29: Cooperative async execution
+  await test('Async execution', async () => {
+    const ctx = await lamina.createContext()
+    try {
+      const run = ctx.execAsync(
+        'var n = 0; var i = 0; while (i < 50000) { n = n + i; i = i + 1; }',
+        { sliceSteps: 500 }
+      )
+      let busy = false
+      try {
+        ctx.calc('1')
+      } catch {
+        busy = true
+      }
+      await run
+      if (!busy) {
+        throw new Error('Context was usable while execAsync() was running')
+      }
+      if (ctx.get('n') !== '1249975000') {
+        throw new Error(`Wrong result: ${ctx.get('n')}`)
+      }
+      // Only the JSPI build and the Node-API addon suspend
+      const suspends = ['wasm-jspi', 'node'].includes(lamina.backend)
+      const yields = ctx.lastYieldCount()
+      if (suspends ? yields < 100 : yields !== 0) {
+        throw new Error(`Unexpected yield count ${yields}`)
+      }
+
+      // Functions defined by an earlier call yield as well
+      ctx.exec(
+        'func count(k) { var j = 0; while (j < k) { j = j + 1; } return j; }'
+      )
+      await ctx.execAsync('var c = count(50000);', { sliceSteps: 500 })
+      const later = ctx.lastYieldCount()
+      if (suspends ? later < 100 : later !== 0) {
+        throw new Error(`Unexpected yield count ${later} in a function`)
+      }
+
+      // Per-call limits apply, and the context stays usable
+      let error = null
+      try {
+        await ctx.execAsync('while (true) { i = i + 1; }', {
+          sliceSteps: 100,
+          limits: { maxSteps: 5000 }
+        })
+      } catch (e) {
+        error = e
+      }
+      if (!(error instanceof LaminaError) || error.kind !== 'limit') {
+        throw new Error(`Expected a limit error, got ${error}`)
+      }
+      if (ctx.calc('n + 1') !== '1249975001') {
+        throw new Error('Context unusable after a failed execAsync()')
+      }
+
+      // Two contexts running at once, with a third used in between
+      const other = await lamina.createContext()
+      const third = await lamina.createContext()
+      try {
+        const loop = (name) =>
+          `var ${name} = 0; while (${name} < 20000) { ${name} = ${name} + 1; }`
+        const both = Promise.all([
+          ctx.execAsync(loop('a'), { sliceSteps: 200 }),
+          other.execAsync(loop('b'), { sliceSteps: 300 })
+        ])
+        if (third.calc('6 * 7') !== '42') {
+          throw new Error('Third context wrong while others were running')
+        }
+        await both
+        if (ctx.get('a') !== '20000' || other.get('b') !== '20000') {
+          throw new Error(`Wrong results ${ctx.get('a')}, ${other.get('b')}`)
+        }
+        try {
+          other.get('a')
+          throw new Error('Concurrent execAsync() calls shared variables')
+        } catch (e) {
+          if (!e.message.includes('not found')) throw e
+        }
+      } finally {
+        other.destroy()
+        third.destroy()
+      }
+    } finally {
+      ctx.destroy()
+    }
+  })
+
+  // Test 30: Source from bytes and streams
+  await test('Source from bytes and streams', async () => {
+    const ctx = await lamina.createContext()
+    const encoder = new TextEncoder()
+    try {
+      ctx.execBuffer(encoder.encode('var k = 41 + 1;'))
+      if (ctx.get('k') !== '42') {
+        throw new Error(`execBuffer: expected 42, got ${ctx.get('k')}`)
+      }
+
+      // Chunks split tokens and multi-byte characters
+      const bytes = encoder.encode(
+        'var t = "日本語"; var total = 0; var j = 0; while (j < 10) { total = total + j; j = j + 1; }'
+      )
+      const chunks = []
+      for (let i = 0; i < bytes.length; i += 7) {
+        chunks.push(bytes.subarray(i, i + 7))
+      }
+      await ctx.execStream(chunks)
+      if (ctx.get('total') !== '45') {
+        throw new Error(`execStream: expected 45, got ${ctx.get('total')}`)
+      }
+
+      // A failing source leaves nothing behind for the next stream
+      async function* failing() {
+        yield 'var broken = (('
+        throw new Error('source failed')
+      }
+      let error = null
+      try {
+        await ctx.execStream(failing())
+      } catch (e) {
+        error = e
+      }
+      if (error?.message !== 'source failed') {
+        throw new Error(`Expected the source error, got ${error}`)
+      }
+      await ctx.execStream(['var after', ' = 7;'])
+      if (ctx.get('after') !== '7') {
+        throw new Error('Stream after a failed one did not run')
+      }
+    } finally {
+      ctx.destroy()
+    }
+  })
+
+  // Test 31: Pooled one-shot calls
+  await test('Interpreter pool', async () => {
+    await lamina.setInterpreterPoolSize(2)
+    const before = await lamina.getInterpreterPoolStats()
+    if (before.capacity !== 2) {
+      throw new Error(`Expected capacity 2, got ${before.capacity}`)
+    }
+    if ((await lamina.executeCode('var pooled = 5;')) !== '') {
+      throw new Error('executeCode failed')
+    }
+    const sum = await lamina.evaluateExpression('2 + 3')
+    if (sum !== '5') throw new Error(`Expected 5, got ${sum}`)
+    // Returned interpreters are reset, so nothing leaks between calls
+    const leaked = await lamina.evaluateExpression('pooled')
+    if (leaked === '5') throw new Error('Variables leaked between calls')
+
+    const after = await lamina.getInterpreterPoolStats()
+    if (after.acquired - before.acquired !== 3) {
+      throw new Error(`Expected 3 acquisitions, got ${after.acquired}`)
+    }
+    if (after.idle !== 1 || after.reused - before.reused < 2) {
+      throw new Error(`Interpreters were not reused: ${JSON.stringify(after)}`)
+    }
+    await lamina.setInterpreterPoolSize(0)
+    if ((await lamina.getInterpreterPoolStats()).idle !== 0) {
+      throw new Error('Shrinking the pool kept idle interpreters')
+    }
+    await lamina.setInterpreterPoolSize(4)
+  })
+
+  // Test 32: Copied state shares nothing mutable
+  await test('Copied state is independent', async () => {
+    const base = await lamina.createContext()
+    const restored = await lamina.createContext()
+    try {
+      // A user function over a global, and print bound to base
+      base.captureOutput().exec(`
+        var count = 0;
+        func bump(step) { count = count + step; print("bump", count); return count; }
+        bump(1);
+      `)
+      base.takeOutput()
+      const snapshot = base.snapshot()
+      const tenant = base.fork()
+      try {
+        tenant.captureOutput().exec('bump(10);')
+        if (tenant.takeOutput() !== 'bump 11\n') {
+          throw new Error('print in a fork did not reach the fork')
+        }
+        if (base.takeOutput() !== '') {
+          throw new Error('print in a fork reached the original')
+        }
+        // Redefining the function in the fork leaves the original alone
+        tenant.exec('func bump(step) { return -1; }')
+        base.exec('bump(2);')
+        if (base.get('count') !== '3' || tenant.get('count') !== '11') {
+          throw new Error(
+            `Counts not independent: ${base.get('count')}, ${tenant.get('count')}`
+          )
+        }
+        if (tenant.calc('bump(1)') !== '-1') {
+          throw new Error('Redefinition in the fork did not take')
+        }
+      } finally {
+        tenant.destroy()
+      }
+
+      // A snapshot restored into another context keeps its functions and
+      // prints to that context
+      restored.captureOutput().restore(snapshot)
+      snapshot.delete()
+      restored.exec('bump(100);')
+      if (restored.takeOutput() !== 'bump 101\n' || base.takeOutput() !== '') {
+        throw new Error('Restored state printed to the wrong context')
+      }
+      if (base.get('count') !== '3') {
+        throw new Error('Restored state shared globals with the original')
+      }
+      // A failed call leaves no call stack behind in either copy
+      try {
+        restored.exec('func boom() { return missing; } boom();')
+      } catch {}
+      if (restored.calc('bump(1)') !== '102' || base.calc('bump(1)') !== '4') {
+        throw new Error('Copies unusable after a failed call')
+      }
+    } finally {
+      restored.destroy()
+      base.destroy()
+    }
+  })
+
   console.log(`\nTests complete: ${passed} passed, ${failed} failed`)
 
   // Cleanup
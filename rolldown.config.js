@@ -14,6 +14,11 @@ const cliConfig = {
   input: './src/cli.ts'
 }
 
+// Loaded by LaminaPool as lib/pool-worker.mjs, next to index.mjs
+const poolWorkerConfig = {
+  input: './src/pool-worker.ts'
+}
+
 export default defineConfig([
   {
     ...config,
@@ -37,6 +42,14 @@ export default defineConfig([
         exports: 'named'
       }
     ],
+    // import.meta does not exist in CommonJS; the sibling files it locates
+    // (lamina.node, the .wasm files, lamina-mt.js, pool-worker.mjs) sit
+    // next to index.cjs as well
+    transform: {
+      define: {
+        'import.meta.url': "require('node:url').pathToFileURL(__filename).href"
+      }
+    },
     external: external
   },
   {
@@ -51,6 +64,18 @@ export default defineConfig([
     plugins: [dts({ emitDtsOnly: true })],
     external: external
   },
+  {
+    ...poolWorkerConfig,
+    output: [
+      {
+        file: 'lib/pool-worker.mjs',
+        format: 'es',
+        minify: true,
+        inlineDynamicImports: true
+      }
+    ],
+    external: external
+  },
   {
     ...cliConfig,
     output: [
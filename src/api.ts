@@ -4,10 +4,116 @@
  * Provides a more intuitive and elegant way to use Lamina in Node.js
  */
 
-import { LaminaInterpreter, isModuleReady } from './interpreter'
+import {
+  LaminaInterpreter,
+  evaluateExpression,
+  executeCode,
+  getBackend,
+  getInterpreterPoolStats,
+  isModuleReady,
+  setInterpreterPoolSize,
+  type LaminaBackend,
+  type LaminaBatchResult,
+  type LaminaBuiltinProfile,
+  type LaminaInterpreterPoolStats,
+  type LaminaLineProfile,
+  type LaminaMemoryUsage,
+  type LaminaParseCacheStats,
+  type LaminaSnapshot,
+  type LaminaTraceEvent,
+  type LaminaValue
+} from './interpreter'
+import {
+  LaminaPool,
+  type LaminaPoolOptions,
+  type LaminaPoolSession,
+  type LaminaPoolStats
+} from './pool'
+
+/**
+ * A Lamina expression parsed once and evaluated many times
+ */
+export class LaminaExpression {
+  private _interpreter: LaminaInterpreter
+  private _handle: number
+
+  /**
+   * @param {LaminaInterpreter} interpreter - Interpreter owning the expression
+   * @param {string} source - Expression source text
+   * @param {number} handle - Handle returned by the interpreter
+   */
+  constructor(
+    interpreter: LaminaInterpreter,
+    readonly source: string,
+    handle: number
+  ) {
+    this._interpreter = interpreter
+    this._handle = handle
+  }
+
+  /**
+   * Evaluate the expression against the current variables
+   * @returns {string} Result
+   */
+  evaluate(): string {
+    if (this._handle < 0) {
+      throw new Error('Expression has been released')
+    }
+    return this._interpreter.evaluate(this._handle)
+  }
+
+  /**
+   * Evaluate the expression once per row over columns of inputs
+   * @param {Record<string, Float64Array>} columns - Columns by variable name
+   * @returns {Float64Array} One result per row
+   */
+  evaluateColumns(columns: Record<string, Float64Array>): Float64Array {
+    if (this._handle < 0) {
+      throw new Error('Expression has been released')
+    }
+    return this._interpreter.evaluateColumns(this._handle, columns)
+  }
+
+  /**
+   * Release the parsed expression
+   */
+  release(): void {
+    if (this._handle < 0) {
+      return
+    }
+    this._interpreter.release(this._handle)
+    this._handle = -1
+  }
+}
+
+/**
+ * Per-call budget for untrusted code
+ * A call that exceeds it throws a LaminaError of kind 'limit'
+ */
+export interface LaminaLimits {
+  // Maximum loop iterations plus function calls
+  maxSteps?: number
+  // Maximum wall-clock time in milliseconds
+  timeoutMs?: number
+}
+
+/**
+ * How often execAsync() hands control back to the event loop
+ * Yields happen at loop iterations and function calls; without either
+ * option the call yields every 8 ms
+ */
+export interface LaminaYieldOptions {
+  // Loop iterations plus function calls between yields
+  sliceSteps?: number
+  // Milliseconds between yields
+  sliceMs?: number
+  // Budget for this call only; time spent yielded does not count
+  limits?: LaminaLimits
+}
 
 export class LaminaContext {
   protected _interpreter: LaminaInterpreter
+  private _limits: LaminaLimits | null = null
 
   /**
    * Create a context with an interpreter instance
@@ -30,10 +136,41 @@ export class LaminaContext {
   /**
    * Calculate an expression and return the result
    * @param {string} expression
+   * @param {LaminaLimits} limits - Budget for this call only
    * @returns {string} Result
    */
-  calc(expression: string): string {
-    return this._interpreter.eval(expression)
+  calc(expression: string, limits?: LaminaLimits): string {
+    return this._limited(limits, () => this._interpreter.eval(expression))
+  }
+
+  /**
+   * Calculate an expression and return a typed JS value
+   * Numbers come back as numbers, bigints as BigInt, rationals as
+   * {num, den} and numeric arrays/matrices as Float64Array plus shape
+   * @param {string} expression
+   * @returns {LaminaValue} Result
+   */
+  calcValue(expression: string): LaminaValue {
+    return this._interpreter.evalValue(expression)
+  }
+
+  /**
+   * Calculate several expressions with a single call into WASM
+   * @param {string[]} expressions
+   * @returns {LaminaBatchResult} Per-expression results and errors
+   */
+  calcBatch(expressions: string[]): LaminaBatchResult {
+    return this._interpreter.evalBatch(expressions)
+  }
+
+  /**
+   * Compile an expression once for repeated evaluation
+   * @param {string} expression
+   * @returns {LaminaExpression} Compiled expression
+   */
+  compile(expression: string): LaminaExpression {
+    const handle = this._interpreter.compile(expression)
+    return new LaminaExpression(this._interpreter, expression, handle)
   }
 
   /**
@@ -51,6 +188,28 @@ export class LaminaContext {
     return this
   }
 
+  /**
+   * Bind many numeric variables at once
+   * @param {string[]} names
+   * @param {Float64Array} values - One value per name
+   * @returns {LaminaContext} this for chaining
+   */
+  bindVariables(names: string[], values: Float64Array): this {
+    this._interpreter.bindVariables(names, values)
+    return this
+  }
+
+  /**
+   * Bind an array variable from a typed array
+   * @param {string} name
+   * @param {Float64Array | Int32Array} values
+   * @returns {LaminaContext} this for chaining
+   */
+  bindArray(name: string, values: Float64Array | Int32Array): this {
+    this._interpreter.bindArray(name, values)
+    return this
+  }
+
   /**
    * Get a variable
    * @param {string} name
@@ -60,18 +219,88 @@ export class LaminaContext {
     return this._interpreter.getVariable(name)
   }
 
+  /**
+   * Get a variable as a typed JS value
+   * @param {string} name
+   * @returns {LaminaValue}
+   */
+  getValue(name: string): LaminaValue {
+    return this._interpreter.getVariableValue(name)
+  }
+
   /**
    * Execute Lamina code
    * @param {string} code
+   * @param {LaminaLimits} limits - Budget for this call only
    * @returns {LaminaContext} this for chaining
    */
-  exec(code: string): this {
-    this._interpreter.execute(code)
+  exec(code: string, limits?: LaminaLimits): this {
+    this._limited(limits, () => this._interpreter.execute(code))
+    return this
+  }
+
+  /**
+   * Execute Lamina code without blocking the event loop
+   * Long-running code yields between slices, so timers, rendering and
+   * other requests keep running meanwhile. Yielding needs the JSPI build,
+   * which is opt-in (LAMINA_BACKEND=wasm-jspi); the Node-API addon runs the
+   * code on a background thread instead, and other builds run it in one go.
+   * The context must not be used until the returned promise settles
+   * @param {string} code
+   * @param {LaminaYieldOptions} options - Slice length and per-call budget
+   * @returns {Promise<LaminaContext>} this, once the code has finished
+   */
+  async execAsync(
+    code: string,
+    options: LaminaYieldOptions = {}
+  ): Promise<this> {
+    const { limits, sliceSteps = 0 } = options
+    const sliceMs = options.sliceMs ?? (sliceSteps > 0 ? 0 : 8)
+    if (limits) {
+      this._applyLimits(limits)
+    }
+    try {
+      await this._interpreter.executeAsync(code, sliceSteps, sliceMs)
+    } finally {
+      if (limits) {
+        this._applyLimits(this._limits)
+      }
+    }
+    return this
+  }
+
+  /**
+   * Get the number of times the last execAsync() call yielded
+   * @returns {number}
+   */
+  lastYieldCount(): number {
+    return this._interpreter.lastYieldCount()
+  }
+
+  /**
+   * Set the budget applied to every exec() and calc() call
+   * @param {LaminaLimits | null} limits - Budget, or null to remove it
+   * @returns {LaminaContext} this for chaining
+   */
+  setLimits(limits: LaminaLimits | null): this {
+    this._limits = limits
+    this._applyLimits(limits)
     return this
   }
 
+  /**
+   * Get the number of steps taken by the last exec() or calc() call
+   * @returns {number}
+   */
+  lastStepCount(): number {
+    return this._interpreter.lastStepCount()
+  }
+
   /**
    * Execute Lamina code from a buffer
+   * UTF-8 buffers are passed to the interpreter as bytes, without decoding
+   * them into a string (the interpreter still copies them once); other
+   * encodings are decoded first
    * @param {Buffer | Uint8Array} buffer - Buffer containing Lamina code
    * @param {string} encoding - Text encoding (default: 'utf-8')
    * @returns {LaminaContext} this for chaining
@@ -80,11 +309,217 @@ export class LaminaContext {
     buffer: Buffer | Uint8Array,
     encoding: BufferEncoding = 'utf-8'
   ): this {
-    const code = Buffer.from(buffer).toString(encoding)
-    this._interpreter.execute(code)
+    if (encoding === 'utf-8' || encoding === 'utf8') {
+      this._interpreter.executeBytes(buffer)
+    } else {
+      this._interpreter.execute(Buffer.from(buffer).toString(encoding))
+    }
+    return this
+  }
+
+  /**
+   * Execute Lamina code that arrives in chunks, e.g. a file or network
+   * stream of a large generated script
+   * Chunks are copied into the interpreter as they arrive and the code runs
+   * once the stream ends, so the script is never held as one JS string. The
+   * interpreter holds the whole source until then, so peak memory still
+   * includes the full script
+   * @param {Iterable<Uint8Array | string> | AsyncIterable<Uint8Array | string>} chunks - UTF-8 chunks or strings
+   * @returns {Promise<LaminaContext>} this, once the code has run
+   */
+  async execStream(
+    chunks: Iterable<Uint8Array | string> | AsyncIterable<Uint8Array | string>
+  ): Promise<this> {
+    await this._interpreter.executeStream(chunks)
+    return this
+  }
+
+  /**
+   * Cap the memory this context may hold
+   * Covers values, bigints, arrays, strings and parsed code allocated by
+   * exec() and calc(); exceeding it throws a LaminaError of kind 'memory'
+   * @param {number} bytes - Quota in bytes, 0 for unlimited
+   * @returns {LaminaContext} this for chaining
+   */
+  setMemoryQuota(bytes: number): this {
+    this._interpreter.setMemoryQuota(bytes)
     return this
   }
 
+  /**
+   * Get the memory held by this context
+   * @returns {LaminaMemoryUsage} Live, peak and quota in bytes
+   */
+  memoryUsage(): LaminaMemoryUsage {
+    return this._interpreter.memoryUsage()
+  }
+
+  /**
+   * Record call counts, timings and argument types of builtin functions
+   * Costs nothing while disabled
+   * @param {boolean} enabled - Whether to profile (default: true)
+   * @returns {LaminaContext} this for chaining
+   */
+  profileBuiltins(enabled = true): this {
+    this._interpreter.setProfiling(enabled)
+    return this
+  }
+
+  /**
+   * Get builtin call statistics, most expensive (self time) first
+   * @returns {LaminaBuiltinProfile[]}
+   */
+  builtinProfile(): LaminaBuiltinProfile[] {
+    return this._interpreter.getProfile()
+  }
+
+  /**
+   * Clear builtin call statistics
+   * @returns {LaminaContext} this for chaining
+   */
+  resetBuiltinProfile(): this {
+    this._interpreter.resetProfile()
+    return this
+  }
+
+  /**
+   * Record time and allocations per source line and call stack
+   * Applies to code passed to exec() while enabled
+   * @param {boolean} enabled - Whether to profile (default: true)
+   * @returns {LaminaContext} this for chaining
+   */
+  profileLines(enabled = true): this {
+    this._interpreter.setLineProfiling(enabled)
+    return this
+  }
+
+  /**
+   * Get per-line statistics, most expensive first
+   * @returns {LaminaLineProfile[]}
+   */
+  lineProfile(): LaminaLineProfile[] {
+    return this._interpreter.getLineProfile()
+  }
+
+  /**
+   * Get the line profile as collapsed stacks for flamegraph tools
+   * @returns {string}
+   */
+  collapsedStacks(): string {
+    return this._interpreter.getCollapsedStacks()
+  }
+
+  /**
+   * Clear line profiling statistics
+   * @returns {LaminaContext} this for chaining
+   */
+  resetLineProfile(): this {
+    this._interpreter.resetLineProfile()
+    return this
+  }
+
+  /**
+   * Start recording a trace of exec()/calc() calls
+   * Records both sides of the JS/WASM boundary, lex/parse/eval phases,
+   * user function calls in code run while tracing, and slow builtins
+   * @param {object} options - Trace options
+   * @param {number} options.capacity - Events kept per side (default: 65536)
+   * @param {number} options.slowBuiltinMs - Record builtin calls taking at least this long (default: 1)
+   * @returns {LaminaContext} this for chaining
+   */
+  startTrace(
+    options: { capacity?: number; slowBuiltinMs?: number } = {}
+  ): this {
+    const { capacity = 65536, slowBuiltinMs = 1 } = options
+    this._interpreter.startTrace(capacity, slowBuiltinMs)
+    return this
+  }
+
+  /**
+   * Stop recording; the trace stays available to exportTrace()
+   * @returns {LaminaContext} this for chaining
+   */
+  stopTrace(): this {
+    this._interpreter.stopTrace()
+    return this
+  }
+
+  /**
+   * Export the trace as Chrome Trace Event JSON for Perfetto or
+   * chrome://tracing
+   * @returns {string}
+   */
+  exportTrace(): string {
+    return this._interpreter.exportTrace()
+  }
+
+  /**
+   * Drop recorded events without stopping the trace
+   * @returns {LaminaContext} this for chaining
+   */
+  clearTrace(): this {
+    this._interpreter.clearTrace()
+    return this
+  }
+
+  /**
+   * Cache parsed programs so repeated exec() calls skip lexing and parsing
+   * @param {object} options - Cache budget
+   * @param {number} options.maxEntries - Maximum cached programs (default: 64)
+   * @param {number} options.maxBytes - Approximate byte budget (default: 4 MiB)
+   * @returns {LaminaContext} this for chaining
+   */
+  enableParseCache(
+    options: { maxEntries?: number; maxBytes?: number } = {}
+  ): this {
+    const { maxEntries = 64, maxBytes = 4 * 1024 * 1024 } = options
+    this._interpreter.enableParseCache(maxEntries, maxBytes)
+    return this
+  }
+
+  /**
+   * Disable the parse cache
+   * @returns {LaminaContext} this for chaining
+   */
+  disableParseCache(): this {
+    this._interpreter.disableParseCache()
+    return this
+  }
+
+  /**
+   * Get parse cache statistics
+   * @returns {LaminaParseCacheStats}
+   */
+  parseCacheStats(): LaminaParseCacheStats {
+    return this._interpreter.getParseCacheStats()
+  }
+
+  /**
+   * Capture print() output instead of writing it to the console
+   * @param {boolean} enabled - Whether to capture output (default: true)
+   * @returns {LaminaContext} this for chaining
+   */
+  captureOutput(enabled = true): this {
+    this._interpreter.setOutputCapture(enabled)
+    return this
+  }
+
+  /**
+   * Drain captured output as a string
+   * @returns {string}
+   */
+  takeOutput(): string {
+    return this._interpreter.takeOutput()
+  }
+
+  /**
+   * Drain captured output as UTF-8 bytes
+   * @returns {Uint8Array}
+   */
+  takeOutputBytes(): Uint8Array {
+    return this._interpreter.takeOutputBytes()
+  }
+
   /**
    * Define a function
    * @param {string} code - Function definition
@@ -115,12 +550,60 @@ export class LaminaContext {
     return this
   }
 
+  /**
+   * Capture the current state (variables, functions and builtins)
+   * Release it with snapshot.delete() when no longer needed
+   * @returns {LaminaSnapshot}
+   */
+  snapshot(): LaminaSnapshot {
+    return this._interpreter.snapshot()
+  }
+
+  /**
+   * Restore a state captured by snapshot()
+   * @param {LaminaSnapshot} snapshot
+   * @returns {LaminaContext} this for chaining
+   */
+  restore(snapshot: LaminaSnapshot): this {
+    this._interpreter.restore(snapshot)
+    return this
+  }
+
+  /**
+   * Create an isolated context starting from this context's state
+   * Variables and functions are shared copy-on-write, so forking a context
+   * with a large preloaded library is cheap
+   * @returns {LaminaContext} The forked context
+   */
+  fork(): LaminaContext {
+    return new LaminaContext(this._interpreter.fork())
+  }
+
   /**
    * Clean up
    */
   destroy(): void {
     this._interpreter.destroy()
   }
+
+  private _applyLimits(limits: LaminaLimits | null): void {
+    this._interpreter.setLimits(limits?.maxSteps ?? 0, limits?.timeoutMs ?? 0)
+  }
+
+  /**
+   * Run a call under per-call limits, then restore the context's own
+   */
+  private _limited<T>(limits: LaminaLimits | undefined, run: () => T): T {
+    if (!limits) {
+      return run()
+    }
+    this._applyLimits(limits)
+    try {
+      return run()
+    } finally {
+      this._applyLimits(this._limits)
+    }
+  }
 }
 
 /**
@@ -132,10 +615,17 @@ let _globalContext: LaminaContext | null = null
 interface LaminaGlobal {
   // Core calculation methods
   init(): Promise<LaminaContext>
-  calc(expression: string): string
+  calc(expression: string, limits?: LaminaLimits): string
+  calcBatch(expressions: string[]): LaminaBatchResult
+  calcValue(expression: string): LaminaValue
+  compile(expression: string): LaminaExpression
   set(name: string, value: number | string): LaminaGlobal
+  bindVariables(names: string[], values: Float64Array): LaminaGlobal
+  bindArray(name: string, values: Float64Array | Int32Array): LaminaGlobal
   get(name: string): string
-  exec(code: string): LaminaGlobal
+  getValue(name: string): LaminaValue
+  exec(code: string, limits?: LaminaLimits): LaminaGlobal
+  execAsync(code: string, options?: LaminaYieldOptions): Promise<LaminaGlobal>
   execBuffer(
     buffer: Buffer | Uint8Array,
     encoding?: BufferEncoding
@@ -144,9 +634,17 @@ interface LaminaGlobal {
 
   // Context management
   createContext(): Promise<LaminaContext>
+  createPool(options?: LaminaPoolOptions): Promise<LaminaPool>
   cleanup(): void
+
+  // One-shot calls on pooled interpreters
+  evaluateExpression(expression: string): Promise<string>
+  executeCode(code: string): Promise<string>
+  setInterpreterPoolSize(size: number): Promise<void>
+  getInterpreterPoolStats(): Promise<LaminaInterpreterPoolStats>
   readonly context: LaminaContext | null
   readonly isReady: boolean
+  readonly backend: LaminaBackend | null
 
   // Type exports
   Context: typeof LaminaContext
@@ -195,13 +693,50 @@ export const lamina: LaminaGlobal = Object.assign(
       return isModuleReady()
     },
 
+    /**
+     * Backend in use: 'node' for the native addon, 'wasm-mt', 'wasm-jspi',
+     * 'wasm-simd' or 'wasm' for a WASM module; null until the module has
+     * loaded
+     */
+    get backend(): LaminaBackend | null {
+      return getBackend()
+    },
+
     /**
      * Quick calculation (auto-initializes if WASM is ready)
      * @param {string} expression
+     * @param {LaminaLimits} limits - Budget for this call only
      * @returns {string} Result
      */
-    calc(expression: string): string {
-      return _ensureGlobalContext().calc(expression)
+    calc(expression: string, limits?: LaminaLimits): string {
+      return _ensureGlobalContext().calc(expression, limits)
+    },
+
+    /**
+     * Typed calculation (auto-initializes if WASM is ready)
+     * @param {string} expression
+     * @returns {LaminaValue} Result
+     */
+    calcValue(expression: string): LaminaValue {
+      return _ensureGlobalContext().calcValue(expression)
+    },
+
+    /**
+     * Batch calculation (auto-initializes if WASM is ready)
+     * @param {string[]} expressions
+     * @returns {LaminaBatchResult} Per-expression results and errors
+     */
+    calcBatch(expressions: string[]): LaminaBatchResult {
+      return _ensureGlobalContext().calcBatch(expressions)
+    },
+
+    /**
+     * Compile an expression (auto-initializes if WASM is ready)
+     * @param {string} expression
+     * @returns {LaminaExpression} Compiled expression
+     */
+    compile(expression: string): LaminaExpression {
+      return _ensureGlobalContext().compile(expression)
     },
 
     /**
@@ -212,6 +747,22 @@ export const lamina: LaminaGlobal = Object.assign(
       return lamina
     },
 
+    /**
+     * Bind many numeric variables (auto-initializes if WASM is ready)
+     */
+    bindVariables(names: string[], values: Float64Array): LaminaGlobal {
+      _ensureGlobalContext().bindVariables(names, values)
+      return lamina
+    },
+
+    /**
+     * Bind an array variable (auto-initializes if WASM is ready)
+     */
+    bindArray(name: string, values: Float64Array | Int32Array): LaminaGlobal {
+      _ensureGlobalContext().bindArray(name, values)
+      return lamina
+    },
+
     /**
      * Get a variable (auto-initializes if WASM is ready)
      */
@@ -219,11 +770,34 @@ export const lamina: LaminaGlobal = Object.assign(
       return _ensureGlobalContext().get(name)
     },
 
+    /**
+     * Get a typed variable value (auto-initializes if WASM is ready)
+     */
+    getValue(name: string): LaminaValue {
+      return _ensureGlobalContext().getValue(name)
+    },
+
     /**
      * Execute code (auto-initializes if WASM is ready)
+     * @param {string} code
+     * @param {LaminaLimits} limits - Budget for this call only
+     */
+    exec(code: string, limits?: LaminaLimits): LaminaGlobal {
+      _ensureGlobalContext().exec(code, limits)
+      return lamina
+    },
+
+    /**
+     * Execute code without blocking the event loop, see
+     * LaminaContext.execAsync() (auto-initializes if WASM is ready)
+     * @param {string} code
+     * @param {LaminaYieldOptions} options - Slice length and per-call budget
      */
-    exec(code: string): LaminaGlobal {
-      _ensureGlobalContext().exec(code)
+    async execAsync(
+      code: string,
+      options?: LaminaYieldOptions
+    ): Promise<LaminaGlobal> {
+      await _ensureGlobalContext().execAsync(code, options)
       return lamina
     },
 
@@ -249,6 +823,54 @@ export const lamina: LaminaGlobal = Object.assign(
       return LaminaContext.create()
     },
 
+    /**
+     * Start a pool of worker threads for async calc/exec (Node.js only)
+     * @param {LaminaPoolOptions} options
+     * @returns {Promise<LaminaPool>}
+     */
+    createPool(options?: LaminaPoolOptions): Promise<LaminaPool> {
+      return LaminaPool.create(options)
+    },
+
+    /**
+     * Evaluate an expression on a warm interpreter from the pool
+     * Nothing is kept between calls: the interpreter is reset when it is
+     * returned to the pool
+     * @param {string} expression
+     * @returns {Promise<string>} Result, or the error message
+     */
+    evaluateExpression(expression: string): Promise<string> {
+      return evaluateExpression(expression)
+    },
+
+    /**
+     * Execute code on a warm interpreter from the pool, see
+     * evaluateExpression()
+     * @param {string} code
+     * @returns {Promise<string>} Empty string, or the error message
+     */
+    executeCode(code: string): Promise<string> {
+      return executeCode(code)
+    },
+
+    /**
+     * Set how many idle interpreters evaluateExpression() and executeCode()
+     * keep warm
+     * @param {number} size - Maximum number of idle interpreters
+     */
+    setInterpreterPoolSize(size: number): Promise<void> {
+      return setInterpreterPoolSize(size)
+    },
+
+    /**
+     * Get statistics of the interpreter pool behind evaluateExpression()
+     * and executeCode()
+     * @returns {Promise<LaminaInterpreterPoolStats>} Pool statistics
+     */
+    getInterpreterPoolStats(): Promise<LaminaInterpreterPoolStats> {
+      return getInterpreterPoolStats()
+    },
+
     /**
      * Clean up global context
      */
@@ -292,4 +914,20 @@ LaminaContext.create()
   })
 
 // Export types for TypeScript users
-export type { LaminaGlobal }
+export type {
+  LaminaGlobal,
+  LaminaBackend,
+  LaminaPool,
+  LaminaPoolOptions,
+  LaminaPoolSession,
+  LaminaPoolStats,
+  LaminaInterpreterPoolStats,
+  LaminaBatchResult,
+  LaminaBuiltinProfile,
+  LaminaLineProfile,
+  LaminaMemoryUsage,
+  LaminaParseCacheStats,
+  LaminaSnapshot,
+  LaminaTraceEvent,
+  LaminaValue
+}
@@ -7,6 +7,8 @@
  * - lamina repl      - Start REPL
  * - lamina <file>    - Execute a Lamina file
  * - lamina run <file>- Execute a Lamina file
+ *   (--profile prints hot lines and writes collapsed stacks,
+ *    --profile-builtins prints builtin call statistics afterwards)
  * - lamina version   - Show version
  * - lamina help      - Show help
  */
@@ -14,7 +16,8 @@
 import * as readline from 'node:readline'
 import * as fs from 'node:fs'
 import * as path from 'node:path'
-import { lamina } from './api'
+import { lamina, type LaminaContext } from './api'
+import type { LaminaBuiltinProfile, LaminaLineProfile } from './interpreter'
 import { version } from '../package.json' with { type: 'json' }
 
 // Version information
@@ -47,6 +50,68 @@ function printWarning(message: string): void {
   console.warn(colorize('Warning: ', 'yellow') + message)
 }
 
+function printBuiltinProfile(profile: LaminaBuiltinProfile[]): void {
+  if (profile.length === 0) {
+    console.log(colorize('No builtin calls recorded', 'dim'))
+    return
+  }
+
+  const header = [
+    'Builtin'.padEnd(24),
+    'Calls'.padStart(10),
+    'Total ms'.padStart(12),
+    'Self ms'.padStart(12),
+    '  Arg types'
+  ]
+  console.log(colorize(header.join(''), 'bright'))
+  for (const entry of profile) {
+    const argTypes = Object.entries(entry.argTypes)
+      .map(([type, count]) => `${type}:${count}`)
+      .join(' ')
+    const row = [
+      entry.name.padEnd(24),
+      String(entry.calls).padStart(10),
+      entry.totalMs.toFixed(3).padStart(12),
+      entry.selfMs.toFixed(3).padStart(12),
+      `  ${argTypes}`
+    ]
+    console.log(row.join(''))
+  }
+}
+
+function printLineProfile(
+  profile: LaminaLineProfile[],
+  sourceLines: string[],
+  limit = 20
+): void {
+  if (profile.length === 0) {
+    console.log(colorize('No lines recorded', 'dim'))
+    return
+  }
+
+  const header = [
+    'Line'.padStart(6),
+    'Hits'.padStart(10),
+    'Time ms'.padStart(12),
+    'Allocs'.padStart(10),
+    '  Function'.padEnd(18),
+    'Source'
+  ]
+  console.log(colorize(header.join(''), 'bright'))
+  for (const entry of profile.slice(0, limit)) {
+    const source = (sourceLines[entry.line - 1] ?? '').trim()
+    const row = [
+      String(entry.line).padStart(6),
+      String(entry.hits).padStart(10),
+      entry.timeMs.toFixed(3).padStart(12),
+      String(entry.allocations).padStart(10),
+      `  ${entry.function}`.padEnd(18),
+      source
+    ]
+    console.log(row.join(''))
+  }
+}
+
 function printHelp(): void {
   console.log(`
 ${colorize('Lamina.js', 'cyan')} v${VERSION}
@@ -60,10 +125,17 @@ ${colorize('Usage:', 'bright')}
   lamina version      Show version information
   lamina help         Show this help message
 
+${colorize('Options:', 'bright')}
+  --profile           Print the hottest lines after running a file and
+                      write collapsed stacks to <file>.folded
+  --profile-builtins  Print builtin call statistics after running a file
+
 ${colorize('Examples:', 'bright')}
   lamina              # Start interactive REPL
   lamina script.lam   # Run a script file
   lamina run calc.lam # Run a script file
+  lamina run --profile calc.lam
+  lamina run --profile-builtins calc.lam
 
 ${colorize('REPL Commands:', 'bright')}
   :exit               Exit the REPL
@@ -72,6 +144,8 @@ ${colorize('REPL Commands:', 'bright')}
   :clear              Clear screen
   :vars               Show all variables
   :reset              Reset the context
+  :profile on|off     Start or stop builtin profiling
+  :profile            Show builtin call statistics
 
 ${colorize('More Info:', 'bright')}
   GitHub: https://github.com/Hoshino-Yumetsuki/lamina.js
@@ -138,6 +212,8 @@ ${colorize('Lamina REPL Commands:', 'bright')}
   :clear              Clear screen
   :vars               Show all variables
   :reset              Reset the context
+  :profile on|off     Start or stop builtin profiling
+  :profile            Show builtin call statistics
 `)
             rl.prompt()
             return
@@ -165,6 +241,28 @@ ${colorize('Lamina REPL Commands:', 'bright')}
             rl.prompt()
             return
 
+          case ':profile on':
+          case ':profile off':
+            if (lamina.context) {
+              const enabled = trimmedLine === ':profile on'
+              lamina.context.profileBuiltins(enabled)
+              console.log(
+                colorize(
+                  `Builtin profiling ${enabled ? 'enabled' : 'disabled'}`,
+                  'green'
+                )
+              )
+            }
+            rl.prompt()
+            return
+
+          case ':profile':
+            if (lamina.context) {
+              printBuiltinProfile(lamina.context.builtinProfile())
+            }
+            rl.prompt()
+            return
+
           default:
             printWarning(`Unknown command: ${trimmedLine}`)
             rl.prompt()
@@ -247,7 +345,35 @@ ${colorize('Lamina REPL Commands:', 'bright')}
   })
 }
 
-async function runFile(filePath: string): Promise<void> {
+interface RunOptions {
+  profile?: boolean
+  profileBuiltins?: boolean
+}
+
+function reportProfiles(
+  context: LaminaContext,
+  options: RunOptions,
+  filePath: string,
+  source: string
+): void {
+  if (options.profile) {
+    console.log()
+    printLineProfile(context.lineProfile(), source.split('\n'))
+
+    const foldedPath = `${path.basename(filePath)}.folded`
+    fs.writeFileSync(foldedPath, context.collapsedStacks())
+    console.log(colorize(`Collapsed stacks written to ${foldedPath}`, 'dim'))
+  }
+  if (options.profileBuiltins) {
+    console.log()
+    printBuiltinProfile(context.builtinProfile())
+  }
+}
+
+async function runFile(
+  filePath: string,
+  options: RunOptions = {}
+): Promise<void> {
   try {
     // Resolve file path
     const resolvedPath = path.resolve(filePath)
@@ -264,7 +390,13 @@ async function runFile(filePath: string): Promise<void> {
     console.log(colorize(`Executing file: ${filePath}`, 'dim'))
 
     // Initialize context
-    await lamina.init()
+    const context = await lamina.init()
+    if (options.profile) {
+      context.profileLines()
+    }
+    if (options.profileBuiltins) {
+      context.profileBuiltins()
+    }
 
     // Execute code from buffer
     try {
@@ -277,9 +409,12 @@ async function runFile(filePath: string): Promise<void> {
       } else {
         printError(String(error))
       }
+      reportProfiles(context, options, filePath, buffer.toString('utf-8'))
       process.exit(1)
     }
 
+    reportProfiles(context, options, filePath, buffer.toString('utf-8'))
+
     lamina.cleanup()
   } catch (error) {
     if (error instanceof Error) {
@@ -292,7 +427,13 @@ async function runFile(filePath: string): Promise<void> {
 }
 
 async function main(): Promise<void> {
-  const args = process.argv.slice(2)
+  const argv = process.argv.slice(2)
+  const flags = ['--profile', '--profile-builtins']
+  const options: RunOptions = {
+    profile: argv.includes('--profile'),
+    profileBuiltins: argv.includes('--profile-builtins')
+  }
+  const args = argv.filter((arg) => !flags.includes(arg))
 
   // No arguments - start REPL
   if (args.length === 0) {
@@ -326,12 +467,12 @@ async function main(): Promise<void> {
         printHelp()
         process.exit(1)
       }
-      await runFile(args[1])
+      await runFile(args[1], options)
       break
 
     default:
       // Assume it's a file path
-      await runFile(command)
+      await runFile(command, options)
       break
   }
 }
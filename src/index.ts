@@ -6,4 +6,26 @@
  */
 
 export { lamina } from './api'
-export type { LaminaGlobal } from './api'
+export { LaminaError } from './interpreter'
+export { LaminaPoolFullError } from './pool'
+export type { LaminaErrorKind } from './interpreter'
+export type {
+  LaminaGlobal,
+  LaminaExpression,
+  LaminaLimits,
+  LaminaYieldOptions,
+  LaminaMemoryUsage,
+  LaminaBackend,
+  LaminaPool,
+  LaminaPoolOptions,
+  LaminaPoolSession,
+  LaminaPoolStats,
+  LaminaInterpreterPoolStats,
+  LaminaBatchResult,
+  LaminaBuiltinProfile,
+  LaminaLineProfile,
+  LaminaParseCacheStats,
+  LaminaSnapshot,
+  LaminaTraceEvent,
+  LaminaValue
+} from './api'
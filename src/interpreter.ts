@@ -1,24 +1,249 @@
 import createLaminaModule from '../lib/lamina.js'
+import createLaminaSimdModule from '../lib/lamina-simd.js'
+
+export interface LaminaRational {
+  type: 'rational'
+  num: bigint
+  den: bigint
+}
+
+export interface LaminaTensor {
+  type: 'array' | 'matrix'
+  data: Float64Array
+  shape: number[]
+}
+
+export interface LaminaSymbolic {
+  type: 'symbolic'
+  text: string
+  approx: number
+}
+
+export interface LaminaOther {
+  type: 'other'
+  text: string
+}
+
+export type LaminaValue =
+  | null
+  | boolean
+  | number
+  | bigint
+  | string
+  | LaminaRational
+  | LaminaTensor
+  | LaminaSymbolic
+  | LaminaOther
+  | LaminaValue[]
+
+interface LaminaWasmError {
+  type: 'error'
+  message: string
+}
+
+export interface LaminaParseCacheStats {
+  hits: number
+  misses: number
+  entries: number
+  bytes: number
+  maxEntries: number
+  maxBytes: number
+}
+
+export interface LaminaMemoryUsage {
+  live: number
+  peak: number
+  quota: number
+}
+
+export interface LaminaBuiltinProfile {
+  name: string
+  calls: number
+  totalMs: number
+  selfMs: number
+  // Argument counts by Lamina type, e.g. { int: 3, float: 1 }
+  argTypes: Record<string, number>
+}
+
+export interface LaminaLineProfile {
+  // Program the line belongs to, numbered from 1 in the order programs
+  // were first run while profiling
+  source: number
+  line: number
+  // Enclosing user function, or '<main>' for top-level code
+  function: string
+  hits: number
+  timeMs: number
+  allocations: number
+}
+
+// A complete event in Chrome Trace Event format, timestamps in microseconds
+export interface LaminaTraceEvent {
+  ph: string
+  cat?: string
+  name: string
+  pid: number
+  tid: number
+  ts?: number
+  dur?: number
+  args?: Record<string, unknown>
+}
+
+// Thread id of spans recorded on the JavaScript side of the boundary
+const JS_TRACE_TID = 2
+
+export interface LaminaSnapshot {
+  delete(): void
+}
+
+export interface LaminaInterpreterPoolStats {
+  capacity: number
+  idle: number
+  created: number
+  acquired: number
+  reused: number
+}
+
+interface LaminaWasmBatch {
+  data: Uint8Array
+  offsets: Uint32Array
+  // ErrorKind of each expression, 0 when it succeeded
+  errors: Uint8Array
+}
 
 interface LaminaWasmInterpreter {
   execute(code: string): string
   eval(expression: string): string
+  executeStatus(code: string): number
+  evalStatus(expression: string): number
+  // Result string, or the ErrorKind of the failure
+  evalString(expression: string): string | number
+  // Only in the JSPI build and the Node-API addon
+  executeAsync?(
+    code: string,
+    sliceSteps: number,
+    sliceMs: number
+  ): Promise<number>
+  lastYieldCount(): number
+  executeBytes(source: number, length: number): number
+  appendSource(chunk: number, length: number): void
+  finishSource(): number
+  discardSource(): void
+  resultString(): string
+  resultValue(): LaminaValue
+  errorKind(): number
+  errorMessage(): string
+  errorOffset(): number
+  evalValue(expression: string): LaminaValue | LaminaWasmError
+  compile(expression: string): number
+  evaluate(handle: number): string
+  // Result string, or the ErrorKind of the failure
+  evaluateString(handle: number): string | number
+  evaluateColumns(
+    handle: number,
+    names: number,
+    nameOffsets: number,
+    columns: number,
+    columnCount: number,
+    rows: number,
+    out: number
+  ): number
+  release(handle: number): void
+  getLastError(): string
+  setLimits(maxSteps: number, timeoutMs: number): void
+  lastStepCount(): number
+  setMemoryQuota(bytes: number): void
+  memoryUsage(): LaminaMemoryUsage
+  setProfiling(enabled: boolean): void
+  getProfile(): LaminaBuiltinProfile[]
+  resetProfile(): void
+  setLineProfiling(enabled: boolean): void
+  getLineProfile(): LaminaLineProfile[]
+  getCollapsedStacks(): string
+  resetLineProfile(): void
+  startTrace(capacity: number, slowBuiltinMs: number): void
+  stopTrace(): void
+  exportTrace(): string
+  clearTrace(): void
+  enableParseCache(maxEntries: number, maxBytes: number): void
+  disableParseCache(): void
+  getParseCacheStats(): LaminaParseCacheStats
+  setOutputCapture(enabled: boolean): void
+  takeOutput(): string
+  outputView(): Uint8Array
+  clearOutput(): void
+  evalBatch(source: number, offsets: number, count: number): LaminaWasmBatch
   setVariable(name: string, value: number): void
   setStringVariable(name: string, value: string): void
+  bindVariables(
+    names: number,
+    nameOffsets: number,
+    values: number,
+    count: number
+  ): void
+  bindArray(name: string, data: number, length: number, isInt: boolean): void
   getVariable(name: string): string
+  getVariableValue(name: string): LaminaValue | LaminaWasmError
   reset(): void
+  snapshot(): LaminaSnapshot
+  restore(snapshot: LaminaSnapshot): void
+  fork(): LaminaWasmInterpreter
   delete(): void
 }
 
 interface LaminaWasmModule {
   LaminaInterpreter: new () => LaminaWasmInterpreter
   evaluateExpression(expression: string): string
+  evaluateExpressionValue(expression: string): LaminaValue | LaminaWasmError
   executeCode(code: string): string
+  setInterpreterPoolSize(size: number): void
+  getInterpreterPoolStats(): LaminaInterpreterPoolStats
+  warmUp(): void
+  _malloc(size: number): number
+  _free(ptr: number): void
+  HEAPU8: Uint8Array
+  HEAPU32: Uint32Array
+  HEAP32: Int32Array
+  HEAPF64: Float64Array
 }
 
+export type LaminaBackend =
+  | 'wasm'
+  | 'wasm-simd'
+  | 'wasm-jspi'
+  | 'wasm-mt'
+  | 'node'
+
+// One of the WASM modules or the Node-API addon (lib/lamina.node), which
+// all expose the same interface
 let wasmModule: LaminaWasmModule | null = null
+let moduleBackend: LaminaBackend | null = null
 let modulePromise: Promise<LaminaWasmModule> | null = null
 let isPreloading = false
+// Compiled .wasm of the loaded module (Node.js only), shared with workers
+let compiledWasm: WebAssembly.Module | null = null
+
+/**
+ * Module a LaminaPool worker is told to use, see getSharedModule()
+ * Set on globalThis before this file is loaded, as loading starts
+ * initialization
+ */
+export interface LaminaSharedModule {
+  backend: LaminaBackend
+  module: WebAssembly.Module | null
+}
+
+const SHARED_MODULE = Symbol.for('lamina.sharedModule')
+
+function sharedModule(): LaminaSharedModule | undefined {
+  return (globalThis as Record<symbol, LaminaSharedModule | undefined>)[
+    SHARED_MODULE
+  ]
+}
+
+function isNode(): boolean {
+  return typeof process !== 'undefined' && !!process.versions?.node
+}
 
 /**
  * Start preloading the WASM module in the background
@@ -35,6 +260,158 @@ function startPreload(): void {
   })
 }
 
+/**
+ * Backend requested through the LAMINA_BACKEND environment variable, or
+ * by the pool that started this worker
+ */
+function requestedBackend(): LaminaBackend | undefined {
+  const shared = sharedModule()
+  if (shared) {
+    return shared.backend
+  }
+  if (typeof process === 'undefined' || !process.env) {
+    return undefined
+  }
+  const backend = process.env.LAMINA_BACKEND
+  return backend === 'wasm' ||
+    backend === 'wasm-simd' ||
+    backend === 'wasm-jspi' ||
+    backend === 'wasm-mt' ||
+    backend === 'node'
+    ? backend
+    : undefined
+}
+
+/**
+ * Whether the host can run the SIMD build
+ * Validates a minimal module using a v128 instruction, since hosts without
+ * SIMD support reject lamina-simd.wasm at compile time
+ */
+function supportsSimd(): boolean {
+  try {
+    return WebAssembly.validate(
+      new Uint8Array([
+        0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10,
+        1, 8, 0, 65, 0, 253, 15, 253, 98, 11
+      ])
+    )
+  } catch {
+    return false
+  }
+}
+
+/**
+ * Whether the host supports JS Promise Integration, which the JSPI build
+ * needs to instantiate
+ */
+function supportsJspi(): boolean {
+  const wasm = WebAssembly as unknown as Record<string, unknown>
+  return (
+    typeof wasm.Suspending === 'function' &&
+    typeof wasm.promising === 'function'
+  )
+}
+
+/**
+ * Load the factory of the JSPI build (lib/lamina-jspi.js)
+ * The build is opt-in (LAMINA_BACKEND=wasm-jspi) and loaded by URL rather
+ * than bundled, so that hosts which never use it do not fetch or parse it
+ * @returns The factory, or null when the host cannot run it
+ */
+async function loadJspiFactory(): Promise<typeof createLaminaModule | null> {
+  if (!supportsSimd() || !supportsJspi()) {
+    return null
+  }
+  try {
+    const url = new URL('./lamina-jspi.js', import.meta.url).href
+    const imported = await import(/* @vite-ignore */ url)
+    return imported.default as typeof createLaminaModule
+  } catch {
+    return null
+  }
+}
+
+/**
+ * Load the factory of the pthreads build (lib/lamina-mt.js)
+ * The file is loaded by URL rather than bundled, because its pthread
+ * workers load it again from the same location. Needs SharedArrayBuffer,
+ * i.e. Node.js or a cross-origin isolated page
+ * @returns The factory, or null when threads are unavailable
+ */
+async function loadThreadedFactory(): Promise<
+  typeof createLaminaModule | null
+> {
+  if (
+    typeof SharedArrayBuffer === 'undefined' ||
+    (globalThis as { crossOriginIsolated?: boolean }).crossOriginIsolated ===
+      false
+  ) {
+    return null
+  }
+  try {
+    const url = new URL('./lamina-mt.js', import.meta.url).href
+    const imported = await import(/* @vite-ignore */ url)
+    return imported.default as typeof createLaminaModule
+  } catch {
+    return null
+  }
+}
+
+/**
+ * Load the Node-API addon when running in Node.js and it has been built
+ * Set LAMINA_BACKEND to a WASM backend to always use a WASM module
+ * @returns The addon, or null to fall back to WASM
+ */
+async function loadNativeModule(): Promise<LaminaWasmModule | null> {
+  const requested = requestedBackend()
+  if (!isNode() || (requested && requested !== 'node')) {
+    return null
+  }
+  try {
+    const { createRequire } = await import('node:module')
+    const require = createRequire(import.meta.url)
+    for (const path of ['./lamina.node', '../lib/lamina.node']) {
+      try {
+        return require(path) as LaminaWasmModule
+      } catch {
+        // Not built, or built for another Node.js ABI
+      }
+    }
+  } catch {
+    // No module loader available
+  }
+  return null
+}
+
+// .wasm file of each backend that initModule() compiles itself
+const WASM_FILES: Partial<Record<LaminaBackend, string>> = {
+  wasm: 'lamina.wasm',
+  'wasm-simd': 'lamina-simd.wasm',
+  'wasm-jspi': 'lamina-jspi.wasm'
+}
+
+/**
+ * Compile the .wasm file of a module next to this file (Node.js only)
+ * initModule() instantiates from the result, so the same
+ * WebAssembly.Module can be handed to pool workers without compiling again
+ * @param {string} file - File name from WASM_FILES
+ * @returns {Promise<WebAssembly.Module | null>} null if it cannot be read
+ */
+async function compileWasm(file: string): Promise<WebAssembly.Module | null> {
+  if (!isNode()) {
+    return null
+  }
+  try {
+    const { readFile } = await import('node:fs/promises')
+    return await WebAssembly.compile(
+      await readFile(new URL(`./${file}`, import.meta.url))
+    )
+  } catch {
+    // Let the module load its .wasm the usual way
+    return null
+  }
+}
+
 export async function initModule(): Promise<LaminaWasmModule> {
   if (wasmModule) {
     return wasmModule
@@ -46,16 +423,79 @@ export async function initModule(): Promise<LaminaWasmModule> {
 
   modulePromise = (async () => {
     try {
+      const native = await loadNativeModule()
+      if (native) {
+        wasmModule = native
+        moduleBackend = 'node'
+        isPreloading = false
+        return native
+      }
+
+      // The threaded and JSPI builds are opt-in (LAMINA_BACKEND=wasm-mt or
+      // wasm-jspi); otherwise prefer the SIMD build unless the baseline one
+      // was asked for
+      const requested = requestedBackend()
+      const optIn =
+        requested === 'wasm-mt'
+          ? await loadThreadedFactory()
+          : requested === 'wasm-jspi'
+            ? await loadJspiFactory()
+            : null
+      let backend: LaminaBackend = 'wasm'
+      let create = createLaminaModule
+      if (optIn) {
+        backend = requested as LaminaBackend
+        create = optIn
+      } else if (requested !== 'wasm' && supportsSimd()) {
+        backend = 'wasm-simd'
+        create = createLaminaSimdModule
+      }
+
+      // Instantiate from a module compiled here (or by the pool's main
+      // thread) so that it can be shared; the threaded build loads its own
+      const compiled =
+        backend === 'wasm-mt'
+          ? null
+          : (sharedModule()?.module ??
+            (await compileWasm(WASM_FILES[backend] ?? 'lamina.wasm')))
+      let instantiateFailed: (error: unknown) => void = () => {}
+      const failure = new Promise<never>((_, reject) => {
+        instantiateFailed = reject
+      })
+
       // Configure stdout/stderr redirection before module initialization
-      const module = (await createLaminaModule({
-        print: (text: string) => {
-          if (text) console.log(text)
-        },
-        printErr: (text: string) => {
-          if (text) console.error(text)
-        }
-      })) as LaminaWasmModule
+      const module = (await Promise.race([
+        create({
+          print: (text: string) => {
+            if (text) console.log(text)
+          },
+          printErr: (text: string) => {
+            if (text) console.error(text)
+          },
+          ...(compiled && {
+            instantiateWasm: (
+              imports: WebAssembly.Imports,
+              receive: (
+                instance: WebAssembly.Instance,
+                module: WebAssembly.Module
+              ) => void
+            ) => {
+              WebAssembly.instantiate(compiled, imports).then(
+                (instance) => receive(instance, compiled),
+                instantiateFailed
+              )
+              return {}
+            }
+          })
+        }),
+        failure
+      ])) as LaminaWasmModule
+      // The runtime is initialized once the factory resolves; build the
+      // prototype interpreter now rather than in the first createContext()
+      module.warmUp()
+      compiledWasm = compiled
       wasmModule = module
+      moduleBackend = backend
       isPreloading = false
       return module
     } catch (error) {
@@ -69,6 +509,18 @@ export async function initModule(): Promise<LaminaWasmModule> {
   return modulePromise
 }
 
+/**
+ * Module for LaminaPool workers to load, after initModule()
+ * module is null for the addon and the threaded build, which workers
+ * load by themselves
+ */
+export function getSharedModule(): LaminaSharedModule | null {
+  if (!moduleBackend) {
+    return null
+  }
+  return { backend: moduleBackend, module: compiledWasm }
+}
+
 /**
  * Check if WASM module is ready (synchronously)
  */
@@ -76,20 +528,269 @@ export function isModuleReady(): boolean {
   return wasmModule !== null
 }
 
+/**
+ * Backend the module was loaded from
+ * @returns 'node' for the Node-API addon, 'wasm-mt', 'wasm-jspi',
+ *   'wasm-simd' or 'wasm' for the threaded, JSPI, SIMD or baseline WASM
+ *   module, or null before initialization
+ */
+export function getBackend(): LaminaBackend | null {
+  return moduleBackend
+}
+
 // Start preloading immediately when this module is imported
 startPreload()
 
+const textEncoder = new TextEncoder()
+const textDecoder = new TextDecoder()
+
+/**
+ * Strings packed into the WASM heap as UTF-8 bytes plus uint32 offsets
+ */
+interface PackedStrings {
+  // Allocation to release with module._free()
+  ptr: number
+  // Address of the concatenated UTF-8 bytes
+  source: number
+  // Address of strings.length + 1 uint32 offsets into source
+  offsets: number
+}
+
+/**
+ * Pack strings into a single WASM heap allocation
+ * @param {LaminaWasmModule} module - Loaded WASM module
+ * @param {string[]} strings - Strings to pack
+ * @returns {PackedStrings} Heap addresses of the packed data
+ */
+function packStrings(
+  module: LaminaWasmModule,
+  strings: string[]
+): PackedStrings {
+  // UTF-8 needs at most 3 bytes per UTF-16 code unit
+  let capacity = 0
+  for (const str of strings) {
+    capacity += str.length * 3
+  }
+  const offsetsSize = (strings.length + 1) * 4
+  const ptr = module._malloc(offsetsSize + capacity)
+  const offsets = ptr
+  const source = ptr + offsetsSize
+
+  // Heap views are read after _malloc, which may have grown the memory
+  const heapU8 = module.HEAPU8
+  const heapU32 = module.HEAPU32
+  let written = 0
+  for (let i = 0; i < strings.length; i++) {
+    heapU32[(offsets >> 2) + i] = written
+    written += textEncoder.encodeInto(
+      strings[i],
+      heapU8.subarray(source + written, source + capacity)
+    ).written
+  }
+  heapU32[(offsets >> 2) + strings.length] = written
+
+  return { ptr, source, offsets }
+}
+
+/**
+ * Typed array located in the WASM heap
+ */
+interface HeapArray {
+  // Heap address of the first element
+  ptr: number
+  // True when the data was copied and must be released with module._free()
+  owned: boolean
+}
+
+/**
+ * Whether a typed array views a detached buffer
+ * A view on a detached buffer reports a length of 0 instead of failing, so
+ * it would silently pass as empty input
+ */
+function isDetached(array: ArrayBufferView): boolean {
+  if (array.byteLength > 0) {
+    return false
+  }
+  try {
+    new Uint8Array(array.buffer, 0, 0)
+    return false
+  } catch {
+    return true
+  }
+}
+
+/**
+ * Get the heap addresses of typed arrays' data
+ * Arrays that already view WASM memory are used in place; anything else is
+ * copied into a fresh heap allocation with a single bulk copy. Views into
+ * the heap are all resolved before the first allocation, since growing the
+ * heap detaches them, so this must be called before anything else is
+ * allocated for the same call
+ * @param {LaminaWasmModule} module - Loaded WASM module
+ * @param {(Float64Array | Int32Array | Uint8Array)[]} arrays - Typed arrays to place
+ * @returns {HeapArray[]} Heap address of each array's data
+ */
+function toHeap(
+  module: LaminaWasmModule,
+  arrays: (Float64Array | Int32Array | Uint8Array)[]
+): HeapArray[] {
+  const placed: (HeapArray | null)[] = arrays.map((array) => {
+    if (isDetached(array)) {
+      throw new TypeError('Cannot read a typed array with a detached buffer')
+    }
+    return array.buffer === module.HEAPU8.buffer
+      ? { ptr: array.byteOffset, owned: false }
+      : null
+  })
+  try {
+    for (let i = 0; i < arrays.length; i++) {
+      if (placed[i]) continue
+      const array = arrays[i]
+      const ptr = module._malloc(Math.max(array.byteLength, 1))
+      placed[i] = { ptr, owned: true }
+      if (array instanceof Float64Array) {
+        module.HEAPF64.set(array, ptr >> 3)
+      } else if (array instanceof Int32Array) {
+        module.HEAP32.set(array, ptr >> 2)
+      } else {
+        module.HEAPU8.set(array, ptr)
+      }
+    }
+  } catch (error) {
+    freeHeap(module, placed)
+    throw error
+  }
+  return placed as HeapArray[]
+}
+
+/**
+ * Release the copies made by toHeap()
+ */
+function freeHeap(module: LaminaWasmModule, placed: (HeapArray | null)[]) {
+  for (const data of placed) {
+    if (data?.owned) module._free(data.ptr)
+  }
+}
+
+/**
+ * Kinds of errors reported by the interpreter
+ */
+export type LaminaErrorKind =
+  | 'syntax'
+  | 'runtime'
+  | 'stdlib'
+  | 'native'
+  | 'limit'
+  | 'memory'
+  | 'unknown'
+
+// Indexed by the status codes of the WASM status ABI (bindings/diagnostic.hpp)
+const ERROR_KINDS: LaminaErrorKind[] = [
+  'unknown',
+  'syntax',
+  'runtime',
+  'stdlib',
+  'native',
+  'unknown',
+  'limit',
+  'memory'
+]
+
+/**
+ * Error thrown when Lamina code fails
+ */
+export class LaminaError extends Error {
+  // What failed: parsing, evaluation, a builtin, ...
+  readonly kind: LaminaErrorKind
+  // Byte offset of the error in the source, or -1 if unknown
+  readonly offset: number
+  // The interpreter's message without the context prefix
+  readonly detail: string
+
+  constructor(
+    context: string,
+    kind: LaminaErrorKind,
+    detail: string,
+    offset = -1
+  ) {
+    super(`${context}: ${detail}`)
+    this.name = 'LaminaError'
+    this.kind = kind
+    this.offset = offset
+    this.detail = detail
+  }
+}
+
+/**
+ * Describe an exception thrown across the WASM boundary
+ * @param {unknown} error - Thrown value
+ * @returns {string} Human readable message
+ */
+function describeNativeError(error: unknown): string {
+  if (error instanceof Error) {
+    return error.message
+  }
+  if (typeof error === 'number') {
+    return `Native error code: ${error} (This usually means a function is not defined or there's a runtime error)`
+  }
+  return String(error)
+}
+
+/**
+ * Throw if a typed entry point reported an error
+ * @param {LaminaValue | LaminaWasmError} result - Raw typed result
+ * @param {string} context - Prefix for the thrown error message
+ * @returns {LaminaValue} The result when it is not an error
+ */
+function unwrapValue(
+  result: LaminaValue | LaminaWasmError,
+  context: string
+): LaminaValue {
+  if (
+    result !== null &&
+    typeof result === 'object' &&
+    !Array.isArray(result) &&
+    result.type === 'error'
+  ) {
+    throw new Error(`${context}: ${result.message}`)
+  }
+  return result as LaminaValue
+}
+
+/**
+ * Result of a batch evaluation
+ */
+export interface LaminaBatchResult {
+  // Result of each expression, or '' when it failed
+  values: string[]
+  // Error message of each expression, or null when it succeeded
+  errors: (string | null)[]
+}
+
 /**
  * LaminaInterpreter wrapper class
  */
 export class LaminaInterpreter {
   private _instance: LaminaWasmInterpreter | null = null
   private _initialized = false
+  // Set while executeAsync() is running; the instance must not be touched
+  private _busy = false
+  // Set while executeStream() is receiving chunks
+  private _streaming = false
+  // Spans recorded on the JS side since the trace was started
+  private _trace: {
+    recording: boolean
+    capacity: number
+    events: LaminaTraceEvent[]
+  } | null = null
 
   /**
    * Auto-initialize on first use if WASM is ready
    */
   private _ensureInitialized(): void {
+    if (this._busy) {
+      throw new Error('LaminaInterpreter is busy running executeAsync()')
+    }
     if (this._initialized && this._instance) {
       return
     }
@@ -126,134 +827,900 @@ export class LaminaInterpreter {
     if (!this._instance) {
       throw new Error('Interpreter instance is not available')
     }
+    let status: number
+    const start = this._trace?.recording ? performance.now() : 0
     try {
-      const result = this._instance.execute(code)
-      // Check if result contains error indicators
-      if (
-        result &&
-        (result.includes('Error:') || result.includes('RuntimeError:'))
-      ) {
-        throw new Error(result)
-      }
-      // Return empty string for successful execution
-      return result
+      status = this._instance.executeStatus(code)
     } catch (error) {
-      // Get more detailed error information
-      let message = 'Unknown error'
-      if (error instanceof Error) {
-        message = error.message
-      } else if (typeof error === 'number') {
-        message = `Native error code: ${error} (This usually means a function is not defined or there's a runtime error)`
-      } else if (typeof error === 'string') {
-        message = error
+      throw new Error(`Lamina execution error: ${describeNativeError(error)}`)
+    } finally {
+      this._traceSpan('execute', start)
+    }
+    if (status !== 0) {
+      throw this._lastError(status, 'Lamina execution error')
+    }
+    // Return empty string for successful execution
+    return ''
+  }
+
+  /**
+   * Execute Lamina code without blocking the event loop
+   * The JSPI build and the Node-API addon suspend the call whenever a
+   * slice of steps or milliseconds is used up and resume it in a later
+   * task. Other builds run it in one go after yielding once. No other
+   * method may be called until it settles
+   * @param {string} code - The Lamina source code to execute
+   * @param {number} sliceSteps - Steps between yields, 0 for no step slice
+   * @param {number} sliceMs - Milliseconds between yields, 0 for no time slice
+   */
+  async executeAsync(
+    code: string,
+    sliceSteps: number,
+    sliceMs: number
+  ): Promise<void> {
+    this._ensureInitialized()
+    const instance = this._instance as LaminaWasmInterpreter
+    let status: number
+    const start = this._trace?.recording ? performance.now() : 0
+    this._busy = true
+    try {
+      if (instance.executeAsync) {
+        status = await instance.executeAsync(code, sliceSteps, sliceMs)
       } else {
-        message = String(error)
+        await new Promise((resolve) => setTimeout(resolve, 0))
+        status = instance.executeStatus(code)
       }
-      throw new Error(`Lamina execution error: ${message}`)
+    } catch (error) {
+      throw new Error(`Lamina execution error: ${describeNativeError(error)}`)
+    } finally {
+      this._busy = false
+      this._traceSpan('executeAsync', start)
+    }
+    if (status !== 0) {
+      throw this._lastError(status, 'Lamina execution error')
     }
   }
 
   /**
-   * Evaluate a Lamina expression
-   * @param {string} expression - The expression to evaluate
-   * @returns {string} The result as a string
+   * Execute Lamina code given as UTF-8 bytes
+   * Skips decoding the bytes into a JS string that the binding would encode
+   * again. The interpreter still copies them once into its own source
+   * string, after bytes outside the WASM heap have been copied into it
+   * @param {Uint8Array} bytes - UTF-8 source
    */
-  eval(expression: string): string {
+  executeBytes(bytes: Uint8Array): void {
     this._ensureInitialized()
-    if (!this._instance) {
+    if (!this._instance || !wasmModule) {
       throw new Error('Interpreter instance is not available')
     }
+    const module = wasmModule
+    const [data] = toHeap(module, [bytes])
+    let status: number
+    const start = this._trace?.recording ? performance.now() : 0
     try {
-      return this._instance.eval(expression)
+      status = this._instance.executeBytes(data.ptr, bytes.byteLength)
     } catch (error) {
-      const message = error instanceof Error ? error.message : String(error)
-      throw new Error(`Lamina evaluation error: ${message}`)
+      throw new Error(`Lamina execution error: ${describeNativeError(error)}`)
+    } finally {
+      freeHeap(module, [data])
+      this._traceSpan('execute', start)
+    }
+    if (status !== 0) {
+      throw this._lastError(status, 'Lamina execution error')
     }
   }
 
   /**
-   * Set a numeric variable
-   * @param {string} name - Variable name
-   * @param {number} value - Numeric value
+   * Execute Lamina code that arrives in chunks
+   * Each chunk is appended to a source buffer in the interpreter as it
+   * arrives, so the script is never built as a JS string or a single JS
+   * buffer. That buffer holds the whole source until the code runs, so the
+   * peak memory use still includes the full script once. Chunks may split
+   * lines and multi-byte characters; the code runs once the source ends.
+   * If the source fails, whatever was received is dropped
+   * @param {Iterable<Uint8Array | string> | AsyncIterable<Uint8Array | string>} chunks - Source chunks
    */
-  setVariable(name: string, value: number): void {
+  async executeStream(
+    chunks: Iterable<Uint8Array | string> | AsyncIterable<Uint8Array | string>
+  ): Promise<void> {
     this._ensureInitialized()
-    if (!this._instance) {
+    if (this._streaming) {
+      throw new Error('LaminaInterpreter is already receiving a stream')
+    }
+    this._streaming = true
+    try {
+      for await (const chunk of chunks) {
+        this._appendSource(
+          typeof chunk === 'string' ? textEncoder.encode(chunk) : chunk
+        )
+      }
+    } catch (error) {
+      if (!this._busy) {
+        this._instance?.discardSource()
+      }
+      throw error
+    } finally {
+      this._streaming = false
+    }
+
+    this._ensureInitialized()
+    const instance = this._instance as LaminaWasmInterpreter
+    let status: number
+    const start = this._trace?.recording ? performance.now() : 0
+    try {
+      status = instance.finishSource()
+    } catch (error) {
+      throw new Error(`Lamina execution error: ${describeNativeError(error)}`)
+    } finally {
+      this._traceSpan('execute', start)
+    }
+    if (status !== 0) {
+      throw this._lastError(status, 'Lamina execution error')
+    }
+  }
+
+  /**
+   * Copy a chunk of source into the interpreter
+   */
+  private _appendSource(chunk: Uint8Array): void {
+    this._ensureInitialized()
+    if (!this._instance || !wasmModule) {
       throw new Error('Interpreter instance is not available')
     }
-    this._instance.setVariable(name, value)
+    const module = wasmModule
+    const [data] = toHeap(module, [chunk])
+    try {
+      this._instance.appendSource(data.ptr, chunk.byteLength)
+    } finally {
+      freeHeap(module, [data])
+    }
   }
 
   /**
-   * Set a string variable
-   * @param {string} name - Variable name
-   * @param {string} value - String value
+   * Get the number of times the last executeAsync() call yielded
    */
-  setStringVariable(name: string, value: string): void {
+  lastYieldCount(): number {
     this._ensureInitialized()
     if (!this._instance) {
       throw new Error('Interpreter instance is not available')
     }
-    this._instance.setStringVariable(name, value)
+    return this._instance.lastYieldCount()
   }
 
   /**
-   * Get a variable value
-   * @param {string} name - Variable name
-   * @returns {string} Variable value as string
+   * Evaluate a Lamina expression
+   * @param {string} expression - The expression to evaluate
+   * @returns {string} The result as a string
    */
-  getVariable(name: string): string {
+  eval(expression: string): string {
     this._ensureInitialized()
     if (!this._instance) {
       throw new Error('Interpreter instance is not available')
     }
+    // Status and result come back from a single call
+    let result: string | number
+    const start = this._trace?.recording ? performance.now() : 0
     try {
-      return this._instance.getVariable(name)
+      result = this._instance.evalString(expression)
     } catch (error) {
-      const message = error instanceof Error ? error.message : String(error)
-      throw new Error(`Variable '${name}' not found: ${message}`)
+      throw new Error(`Lamina evaluation error: ${describeNativeError(error)}`)
+    } finally {
+      this._traceSpan('eval', start)
     }
+    if (typeof result === 'number') {
+      throw this._lastError(result, 'Lamina evaluation error')
+    }
+    return result
   }
 
-  reset(): void {
+  /**
+   * Evaluate an expression through the status ABI, throwing on failure
+   */
+  private _evalStatus(expression: string): void {
     this._ensureInitialized()
     if (!this._instance) {
       throw new Error('Interpreter instance is not available')
     }
-    this._instance.reset()
+    let status: number
+    const start = this._trace?.recording ? performance.now() : 0
+    try {
+      status = this._instance.evalStatus(expression)
+    } catch (error) {
+      throw new Error(`Lamina evaluation error: ${describeNativeError(error)}`)
+    } finally {
+      this._traceSpan('eval', start)
+    }
+    if (status !== 0) {
+      throw this._lastError(status, 'Lamina evaluation error')
+    }
   }
 
   /**
-   * Clean up and free resources
+   * Record a call across the JS/WASM boundary that started at start
    */
-  destroy(): void {
-    if (this._instance && 'delete' in this._instance) {
-      this._instance.delete()
+  private _traceSpan(name: string, start: number): void {
+    if (!this._trace?.recording) {
+      return
+    }
+    const events = this._trace.events
+    events.push({
+      ph: 'X',
+      cat: 'js',
+      name,
+      pid: 1,
+      tid: JS_TRACE_TID,
+      ts: start * 1000,
+      dur: (performance.now() - start) * 1000
+    })
+    if (events.length > this._trace.capacity) {
+      events.shift()
     }
-    this._instance = null
-    this._initialized = false
   }
 
   /**
-   * Get Lamina.js version
-   * @returns {Promise<string>} Version string
+   * Build a LaminaError from the interpreter's last failure
+   * Diagnostics are only read here, so successful calls never fetch them
    */
-  static async getVersion(): Promise<string> {
-    return '1.0.0' // Version can be extracted from WASM if available
+  private _lastError(status: number, context: string): LaminaError {
+    const instance = this._instance as LaminaWasmInterpreter
+    return new LaminaError(
+      context,
+      ERROR_KINDS[status] ?? 'unknown',
+      instance.errorMessage(),
+      instance.errorOffset()
+    )
   }
-}
-
-/**
- * Quick evaluate function
- * @param {string} expression - Expression to evaluate
- * @returns {Promise<string>} Result as string
- */
-export async function evaluateExpression(expression: string): Promise<string> {
-  const module = await initModule()
-  return module.evaluateExpression(expression)
-}
 
-/**
+  /**
+   * Evaluate a Lamina expression and return a typed JS value
+   * @param {string} expression - The expression to evaluate
+   * @returns {LaminaValue} The result as a JS value
+   */
+  evalValue(expression: string): LaminaValue {
+    this._evalStatus(expression)
+    return (this._instance as LaminaWasmInterpreter).resultValue()
+  }
+
+  /**
+   * Compile a Lamina expression for repeated evaluation
+   * @param {string} expression - The expression to compile
+   * @returns {number} Handle of the compiled expression
+   */
+  compile(expression: string): number {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    const handle = this._instance.compile(expression)
+    if (handle < 0) {
+      throw this._lastError(this._instance.errorKind(), 'Lamina compile error')
+    }
+    return handle
+  }
+
+  /**
+   * Evaluate a compiled expression
+   * @param {number} handle - Handle returned by compile()
+   * @returns {string} The result as a string
+   */
+  evaluate(handle: number): string {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    let result: string | number
+    try {
+      result = this._instance.evaluateString(handle)
+    } catch (error) {
+      throw new Error(`Lamina evaluation error: ${describeNativeError(error)}`)
+    }
+    if (typeof result === 'number') {
+      throw this._lastError(result, 'Lamina evaluation error')
+    }
+    return result
+  }
+
+  /**
+   * Evaluate a compiled expression once per row over columns of inputs
+   * Each column is bound to the variable with the same name; purely numeric
+   * expressions run on a float64 fast path inside WASM
+   * @param {number} handle - Handle returned by compile()
+   * @param {Record<string, Float64Array>} columns - Input columns by name
+   * @returns {Float64Array} One result per row
+   */
+  evaluateColumns(
+    handle: number,
+    columns: Record<string, Float64Array>
+  ): Float64Array {
+    this._ensureInitialized()
+    if (!this._instance || !wasmModule) {
+      throw new Error('Interpreter instance is not available')
+    }
+    const names = Object.keys(columns)
+    if (names.length === 0) {
+      throw new Error('evaluateColumns requires at least one column')
+    }
+    const rows = columns[names[0]].length
+    for (const name of names) {
+      if (columns[name].length !== rows) {
+        throw new Error(
+          `Column '${name}' has ${columns[name].length} rows, expected ${rows}`
+        )
+      }
+    }
+
+    const module = wasmModule
+    const data = toHeap(module, names.map((name) => columns[name]))
+    const packed = packStrings(module, names)
+    const table = module._malloc(names.length * 4)
+    const out = module._malloc(Math.max(rows * 8, 1))
+    try {
+      for (let i = 0; i < data.length; i++) {
+        module.HEAPU32[(table >> 2) + i] = data[i].ptr
+      }
+      const status = this._instance.evaluateColumns(
+        handle,
+        packed.source,
+        packed.offsets,
+        table,
+        names.length,
+        rows,
+        out
+      )
+      if (status < 0) {
+        throw this._lastError(-status, 'Lamina evaluation error')
+      }
+      return module.HEAPF64.slice(out >> 3, (out >> 3) + rows)
+    } finally {
+      module._free(out)
+      module._free(table)
+      freeHeap(module, data)
+      module._free(packed.ptr)
+    }
+  }
+
+  /**
+   * Release a compiled expression
+   * @param {number} handle - Handle returned by compile()
+   */
+  release(handle: number): void {
+    if (!this._instance) {
+      return
+    }
+    this._instance.release(handle)
+  }
+
+  /**
+   * Evaluate several expressions with a single call into WASM
+   * @param {string[]} expressions - The expressions to evaluate, in order
+   * @returns {LaminaBatchResult} Per-expression results and errors
+   */
+  evalBatch(expressions: string[]): LaminaBatchResult {
+    this._ensureInitialized()
+    if (!this._instance || !wasmModule) {
+      throw new Error('Interpreter instance is not available')
+    }
+    const module = wasmModule
+    const packed = packStrings(module, expressions)
+    try {
+      const batch = this._instance.evalBatch(
+        packed.source,
+        packed.offsets,
+        expressions.length
+      )
+      const values: string[] = new Array(expressions.length)
+      const errors: (string | null)[] = new Array(expressions.length)
+      for (let i = 0; i < expressions.length; i++) {
+        const text = textDecoder.decode(
+          batch.data.subarray(batch.offsets[i], batch.offsets[i + 1])
+        )
+        values[i] = batch.errors[i] ? '' : text
+        errors[i] = batch.errors[i] ? text : null
+      }
+      return { values, errors }
+    } finally {
+      module._free(packed.ptr)
+    }
+  }
+
+  /**
+   * Set a numeric variable
+   * @param {string} name - Variable name
+   * @param {number} value - Numeric value
+   */
+  setVariable(name: string, value: number): void {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    this._instance.setVariable(name, value)
+  }
+
+  /**
+   * Set a string variable
+   * @param {string} name - Variable name
+   * @param {string} value - String value
+   */
+  setStringVariable(name: string, value: string): void {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    this._instance.setStringVariable(name, value)
+  }
+
+  /**
+   * Bind many numeric variables with a single call into WASM
+   * @param {string[]} names - Variable names
+   * @param {Float64Array} values - Variable values, one per name
+   */
+  bindVariables(names: string[], values: Float64Array): void {
+    this._ensureInitialized()
+    if (!this._instance || !wasmModule) {
+      throw new Error('Interpreter instance is not available')
+    }
+    if (names.length !== values.length) {
+      throw new Error(
+        `Expected ${names.length} values for bindVariables, got ${values.length}`
+      )
+    }
+    const module = wasmModule
+    const [data] = toHeap(module, [values])
+    const packed = packStrings(module, names)
+    try {
+      this._instance.bindVariables(
+        packed.source,
+        packed.offsets,
+        data.ptr,
+        names.length
+      )
+    } finally {
+      freeHeap(module, [data])
+      module._free(packed.ptr)
+    }
+  }
+
+  /**
+   * Bind an array variable from a typed array
+   * @param {string} name - Variable name
+   * @param {Float64Array | Int32Array} values - Array elements
+   */
+  bindArray(name: string, values: Float64Array | Int32Array): void {
+    this._ensureInitialized()
+    if (!this._instance || !wasmModule) {
+      throw new Error('Interpreter instance is not available')
+    }
+    const module = wasmModule
+    const [data] = toHeap(module, [values])
+    try {
+      this._instance.bindArray(
+        name,
+        data.ptr,
+        values.length,
+        values instanceof Int32Array
+      )
+    } finally {
+      freeHeap(module, [data])
+    }
+  }
+
+  /**
+   * Get a variable value
+   * @param {string} name - Variable name
+   * @returns {string} Variable value as string
+   */
+  getVariable(name: string): string {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    try {
+      return this._instance.getVariable(name)
+    } catch (error) {
+      const message = error instanceof Error ? error.message : String(error)
+      throw new Error(`Variable '${name}' not found: ${message}`)
+    }
+  }
+
+  /**
+   * Get a variable value as a typed JS value
+   * @param {string} name - Variable name
+   * @returns {LaminaValue} Variable value
+   */
+  getVariableValue(name: string): LaminaValue {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    return unwrapValue(
+      this._instance.getVariableValue(name),
+      `Variable '${name}' not found`
+    )
+  }
+
+  /**
+   * Limit the work done by each execute()/eval() call
+   * A call that runs out of budget throws a LaminaError of kind 'limit'
+   * and leaves the interpreter usable
+   * @param {number} maxSteps - Maximum loop iterations/function calls, 0 for unlimited
+   * @param {number} timeoutMs - Maximum wall-clock time in ms, 0 for unlimited
+   */
+  setLimits(maxSteps: number, timeoutMs: number): void {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    this._instance.setLimits(maxSteps, timeoutMs)
+  }
+
+  /**
+   * Get the number of steps taken by the last execute()/eval() call
+   */
+  lastStepCount(): number {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    return this._instance.lastStepCount()
+  }
+
+  /**
+   * Cap the heap charged to this interpreter
+   * An allocation over the quota throws a LaminaError of kind 'memory'
+   * and leaves the interpreter usable
+   * @param {number} bytes - Quota in bytes, 0 for unlimited
+   */
+  setMemoryQuota(bytes: number): void {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    this._instance.setMemoryQuota(bytes)
+  }
+
+  /**
+   * Get heap usage charged to this interpreter
+   * @returns {LaminaMemoryUsage} Live, peak and quota in bytes
+   */
+  memoryUsage(): LaminaMemoryUsage {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    return this._instance.memoryUsage()
+  }
+
+  /**
+   * Turn builtin call profiling on or off
+   * @param {boolean} enabled - Whether to profile builtin calls
+   */
+  setProfiling(enabled: boolean): void {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    this._instance.setProfiling(enabled)
+  }
+
+  /**
+   * Get builtin call statistics, most expensive (self time) first
+   * @returns {LaminaBuiltinProfile[]} One entry per builtin called
+   */
+  getProfile(): LaminaBuiltinProfile[] {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    return this._instance.getProfile()
+  }
+
+  /**
+   * Clear builtin call statistics
+   */
+  resetProfile(): void {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    this._instance.resetProfile()
+  }
+
+  /**
+   * Turn line profiling on or off
+   * Only code executed while profiling is on is instrumented
+   * @param {boolean} enabled - Whether to profile lines
+   */
+  setLineProfiling(enabled: boolean): void {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    this._instance.setLineProfiling(enabled)
+  }
+
+  /**
+   * Get per-line statistics, most expensive first
+   * @returns {LaminaLineProfile[]} One entry per line and function
+   */
+  getLineProfile(): LaminaLineProfile[] {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    return this._instance.getLineProfile()
+  }
+
+  /**
+   * Get time per call stack in collapsed-stack format (microseconds)
+   * @returns {string} One "frame;frame;leaf:line value" entry per line
+   */
+  getCollapsedStacks(): string {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    return this._instance.getCollapsedStacks()
+  }
+
+  /**
+   * Clear line profiling statistics
+   */
+  resetLineProfile(): void {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    this._instance.resetLineProfile()
+  }
+
+  /**
+   * Start recording a trace, discarding any previous one
+   * Records execute()/eval() calls on both sides of the JS/WASM boundary,
+   * their lex/parse/eval phases, user function calls and slow builtins
+   * @param {number} capacity - Events kept per side, oldest dropped first
+   * @param {number} slowBuiltinMs - Builtin calls taking at least this long are recorded
+   */
+  startTrace(capacity: number, slowBuiltinMs: number): void {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    this._instance.startTrace(capacity, slowBuiltinMs)
+    this._trace = {
+      recording: true,
+      capacity: capacity > 0 ? capacity : 65536,
+      events: []
+    }
+  }
+
+  /**
+   * Stop recording; the trace is kept until cleared or restarted
+   */
+  stopTrace(): void {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    this._instance.stopTrace()
+    if (this._trace) {
+      this._trace.recording = false
+    }
+  }
+
+  /**
+   * Export the trace in Chrome Trace Event format
+   * Loads in Perfetto or chrome://tracing; timestamps share the
+   * performance.now() clock so they line up with other Node-side traces
+   * @returns {string} JSON object with a traceEvents array
+   */
+  exportTrace(): string {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    const trace = JSON.parse(this._instance.exportTrace())
+    trace.traceEvents.push(
+      {
+        ph: 'M',
+        pid: 1,
+        tid: JS_TRACE_TID,
+        name: 'thread_name',
+        args: { name: 'lamina (js)' }
+      },
+      ...(this._trace?.events ?? [])
+    )
+    return JSON.stringify(trace)
+  }
+
+  /**
+   * Drop recorded events without stopping the trace
+   */
+  clearTrace(): void {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    this._instance.clearTrace()
+    if (this._trace) {
+      this._trace.events = []
+    }
+  }
+
+  /**
+   * Enable the parse cache for execute()
+   * @param {number} maxEntries - Maximum number of cached programs
+   * @param {number} maxBytes - Approximate memory budget in bytes
+   */
+  enableParseCache(maxEntries: number, maxBytes: number): void {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    this._instance.enableParseCache(maxEntries, maxBytes)
+  }
+
+  /**
+   * Disable the parse cache and drop cached programs
+   */
+  disableParseCache(): void {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    this._instance.disableParseCache()
+  }
+
+  /**
+   * Get parse cache statistics
+   * @returns {LaminaParseCacheStats} Hit/miss counters and usage
+   */
+  getParseCacheStats(): LaminaParseCacheStats {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    return this._instance.getParseCacheStats()
+  }
+
+  /**
+   * Enable or disable output capture
+   * While capturing, print() output is kept in a WASM-side buffer instead of
+   * being written to the console
+   * @param {boolean} enabled - Whether to capture output
+   */
+  setOutputCapture(enabled: boolean): void {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    this._instance.setOutputCapture(enabled)
+  }
+
+  /**
+   * Drain captured output as a string
+   * @returns {string} Output captured since the last drain
+   */
+  takeOutput(): string {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    return this._instance.takeOutput()
+  }
+
+  /**
+   * Drain captured output as UTF-8 bytes
+   * @returns {Uint8Array} Output captured since the last drain
+   */
+  takeOutputBytes(): Uint8Array {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    const bytes = this._instance.outputView().slice()
+    this._instance.clearOutput()
+    return bytes
+  }
+
+  reset(): void {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    this._instance.reset()
+  }
+
+  /**
+   * Capture the current interpreter state
+   * The snapshot must be released with snapshot.delete() when no longer needed
+   * @returns {LaminaSnapshot} Captured state
+   */
+  snapshot(): LaminaSnapshot {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    return this._instance.snapshot()
+  }
+
+  /**
+   * Restore a state captured by snapshot()
+   * @param {LaminaSnapshot} snapshot - Captured state
+   */
+  restore(snapshot: LaminaSnapshot): void {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    this._instance.restore(snapshot)
+  }
+
+  /**
+   * Create an isolated interpreter starting from the current state
+   * State is shared copy-on-write, so forking a preloaded interpreter is
+   * cheap and never re-executes its code
+   * @returns {LaminaInterpreter} The forked interpreter
+   */
+  fork(): LaminaInterpreter {
+    this._ensureInitialized()
+    if (!this._instance) {
+      throw new Error('Interpreter instance is not available')
+    }
+    const forked = new LaminaInterpreter()
+    forked._instance = this._instance.fork()
+    forked._initialized = true
+    return forked
+  }
+
+  /**
+   * Clean up and free resources
+   */
+  destroy(): void {
+    if (this._busy) {
+      throw new Error('LaminaInterpreter is busy running executeAsync()')
+    }
+    if (this._instance && 'delete' in this._instance) {
+      this._instance.delete()
+    }
+    this._instance = null
+    this._initialized = false
+  }
+
+  /**
+   * Get Lamina.js version
+   * @returns {Promise<string>} Version string
+   */
+  static async getVersion(): Promise<string> {
+    return '1.0.0' // Version can be extracted from WASM if available
+  }
+}
+
+/**
+ * Quick evaluate function
+ * @param {string} expression - Expression to evaluate
+ * @returns {Promise<string>} Result as string
+ */
+export async function evaluateExpression(expression: string): Promise<string> {
+  const module = await initModule()
+  return module.evaluateExpression(expression)
+}
+
+/**
+ * Quick evaluate function returning a typed JS value
+ * @param {string} expression - Expression to evaluate
+ * @returns {Promise<LaminaValue>} Result as a JS value
+ */
+export async function evaluateExpressionValue(
+  expression: string
+): Promise<LaminaValue> {
+  const module = await initModule()
+  return unwrapValue(
+    module.evaluateExpressionValue(expression),
+    'Lamina evaluation error'
+  )
+}
+
+/**
  * Quick execute function
  * @param {string} code - Code to execute
  * @returns {Promise<string>} Execution result
@@ -263,6 +1730,27 @@ export async function executeCode(code: string): Promise<string> {
   return module.executeCode(code)
 }
 
+/**
+ * Set how many warm interpreters evaluateExpression() and executeCode() keep
+ * @param {number} size - Maximum number of idle pooled interpreters
+ */
+export async function setInterpreterPoolSize(size: number): Promise<void> {
+  const module = await initModule()
+  module.setInterpreterPoolSize(size)
+}
+
+/**
+ * Get statistics of the interpreter pool behind evaluateExpression() and
+ * executeCode()
+ * @returns {Promise<LaminaInterpreterPoolStats>} Pool statistics
+ */
+export async function getInterpreterPoolStats(): Promise<
+  LaminaInterpreterPoolStats
+> {
+  const module = await initModule()
+  return module.getInterpreterPoolStats()
+}
+
 /**
  * Create a new Lamina interpreter instance
  * @returns {Promise<LaminaInterpreter>} Initialized interpreter
@@ -0,0 +1,109 @@
+/**
+ * Lamina.js - LaminaPool worker
+ *
+ * Runs in a worker_threads Worker started by LaminaPool. Holds one warm
+ * context for stateless requests, which is reset after every exec, plus
+ * one forked context per session pinned to this worker.
+ */
+
+import { parentPort, workerData } from 'node:worker_threads'
+import type { LaminaContext } from './api'
+import type { LaminaSharedModule } from './interpreter'
+import type { PoolRequest, PoolResponse } from './pool'
+
+if (!parentPort) {
+  throw new Error('pool-worker must be started by LaminaPool')
+}
+const port = parentPort
+
+// Must be in place before the interpreter module loads, as loading starts
+// initialization; hence the dynamic imports below
+;(globalThis as Record<symbol, LaminaSharedModule>)[
+  Symbol.for('lamina.sharedModule')
+] = workerData as LaminaSharedModule
+
+const ready = (async () => {
+  const { LaminaContext } = await import('./api')
+  const base = await LaminaContext.create()
+  base.captureOutput(true)
+  return base
+})()
+
+const sessions = new Map<number, LaminaContext>()
+
+/**
+ * Context for a request: its session's, or the shared one
+ */
+function contextFor(base: LaminaContext, session?: number): LaminaContext {
+  if (session === undefined) {
+    return base
+  }
+  const context = sessions.get(session)
+  if (!context) {
+    throw new Error(`Unknown session ${session}`)
+  }
+  return context
+}
+
+/**
+ * Run a request, leaving the shared context as it was
+ * @returns {unknown} Result sent back to the pool
+ */
+function handle(base: LaminaContext, request: PoolRequest): unknown {
+  switch (request.op) {
+    case 'calc':
+      return contextFor(base, request.session).calc(
+        request.source,
+        request.limits
+      )
+    case 'exec': {
+      const context = contextFor(base, request.session)
+      try {
+        context.exec(request.source, request.limits)
+        return context.takeOutput()
+      } catch (error) {
+        context.takeOutput()
+        throw error
+      } finally {
+        if (request.session === undefined) {
+          context.reset()
+        }
+      }
+    }
+    case 'set':
+      contextFor(base, request.session).set(request.name, request.value)
+      return undefined
+    case 'get':
+      return contextFor(base, request.session).get(request.name)
+    case 'open': {
+      const context = base.fork()
+      context.captureOutput(true)
+      sessions.set(request.session, context)
+      return undefined
+    }
+    case 'close':
+      sessions.get(request.session)?.destroy()
+      sessions.delete(request.session)
+      return undefined
+  }
+}
+
+port.on('message', async (request: PoolRequest) => {
+  let response: PoolResponse
+  try {
+    response = { id: request.id, ok: true, value: handle(await ready, request) }
+  } catch (error) {
+    const e = error instanceof Error ? error : new Error(String(error))
+    const { kind, detail, offset } = e as Error & {
+      kind?: string
+      detail?: string
+      offset?: number
+    }
+    response = {
+      id: request.id,
+      ok: false,
+      error: { message: e.message, kind, detail, offset }
+    }
+  }
+  port.postMessage(response)
+})
@@ -0,0 +1,481 @@
+/**
+ * Lamina.js - Worker thread pool
+ *
+ * Runs Lamina code on Node.js worker_threads so that heavy scripts do not
+ * block the calling thread. Every worker instantiates the module compiled
+ * by initModule() on the main thread, so starting one does not compile
+ * the WASM again.
+ */
+
+import type { LaminaLimits } from './api'
+import {
+  getSharedModule,
+  initModule,
+  LaminaError,
+  type LaminaErrorKind
+} from './interpreter'
+
+// Messages between LaminaPool and pool-worker.ts
+export type PoolCall =
+  | {
+      op: 'calc' | 'exec'
+      source: string
+      session?: number
+      limits?: LaminaLimits
+    }
+  | { op: 'set'; name: string; value: number | string; session?: number }
+  | { op: 'get'; name: string; session?: number }
+  | { op: 'open' | 'close'; session: number }
+
+export type PoolRequest = PoolCall & { id: number }
+
+export type PoolResponse =
+  | { id: number; ok: true; value: unknown }
+  | {
+      id: number
+      ok: false
+      error: { message: string; kind?: string; detail?: string; offset?: number }
+    }
+
+export interface LaminaPoolOptions {
+  // Number of workers (default: available parallelism)
+  size?: number
+  // Requests allowed to wait for a worker before calls are rejected
+  // with LaminaPoolFullError (default: 1024)
+  maxQueue?: number
+  // Budget for calc/exec calls that do not pass their own
+  limits?: LaminaLimits
+}
+
+export interface LaminaPoolStats {
+  // Live workers
+  workers: number
+  // Workers running a request
+  busy: number
+  // Requests waiting for a worker
+  queued: number
+  // Open sessions
+  sessions: number
+  completed: number
+  failed: number
+  // Calls refused because the queue was full
+  rejected: number
+}
+
+/**
+ * Thrown by LaminaPool calls while maxQueue requests are waiting
+ */
+export class LaminaPoolFullError extends Error {
+  constructor(maxQueue: number) {
+    super(`LaminaPool queue is full (${maxQueue} requests waiting)`)
+    this.name = 'LaminaPoolFullError'
+  }
+}
+
+interface Task {
+  call: PoolCall
+  resolve: (value: unknown) => void
+  reject: (error: Error) => void
+}
+
+interface PoolWorker {
+  worker: import('node:worker_threads').Worker
+  // Request being run; workers get one request at a time
+  current: Task | null
+  // Requests of sessions living on this worker
+  pinned: Task[]
+  sessions: number
+  // Responses received; a worker that fails before any is not restarted
+  handled: number
+  dead: boolean
+}
+
+/**
+ * Rebuild an error sent back by a worker
+ */
+function toError(error: {
+  message: string
+  kind?: string
+  detail?: string
+  offset?: number
+}): Error {
+  if (error.kind && error.detail !== undefined) {
+    const context = error.message.slice(
+      0,
+      Math.max(0, error.message.length - error.detail.length - 2)
+    )
+    return new LaminaError(
+      context,
+      error.kind as LaminaErrorKind,
+      error.detail,
+      error.offset
+    )
+  }
+  return new Error(error.message)
+}
+
+/**
+ * Pool of worker threads, each holding a warm interpreter
+ * Stateless calc/exec calls go to whichever worker is free. Sessions keep
+ * their own variables and always run on the worker they were opened on
+ */
+export class LaminaPool {
+  private _workers: PoolWorker[] = []
+  private _queue: Task[] = []
+  private _spawn: () => PoolWorker['worker']
+  private _maxQueue: number
+  private _limits: LaminaLimits | undefined
+  private _nextId = 1
+  private _nextSession = 1
+  private _completed = 0
+  private _failed = 0
+  private _rejected = 0
+  private _closed = false
+
+  private constructor(
+    spawn: () => PoolWorker['worker'],
+    maxQueue: number,
+    limits: LaminaLimits | undefined
+  ) {
+    this._spawn = spawn
+    this._maxQueue = maxQueue
+    this._limits = limits
+  }
+
+  /**
+   * Start a pool
+   * @param {LaminaPoolOptions} options
+   * @returns {Promise<LaminaPool>}
+   */
+  static async create(options: LaminaPoolOptions = {}): Promise<LaminaPool> {
+    await initModule()
+    const shared = getSharedModule()
+    const { Worker } = await import('node:worker_threads')
+    const { availableParallelism } = await import('node:os')
+
+    const url = new URL('./pool-worker.mjs', import.meta.url)
+    const pool = new LaminaPool(
+      () => new Worker(url, { workerData: shared }),
+      options.maxQueue ?? 1024,
+      options.limits
+    )
+    const size = Math.max(1, options.size ?? availableParallelism())
+    for (let i = 0; i < size; i++) {
+      pool._workers.push(pool._startWorker())
+    }
+    return pool
+  }
+
+  /**
+   * Calculate an expression on a free worker
+   * @param {string} expression
+   * @param {LaminaLimits} limits - Budget for this call only
+   * @returns {Promise<string>} Result
+   */
+  calc(expression: string, limits?: LaminaLimits): Promise<string> {
+    return this._submit({
+      op: 'calc',
+      source: expression,
+      limits: limits ?? this._limits
+    }) as Promise<string>
+  }
+
+  /**
+   * Execute code on a free worker, starting from a fresh context
+   * @param {string} code
+   * @param {LaminaLimits} limits - Budget for this call only
+   * @returns {Promise<string>} Output printed by the code
+   */
+  exec(code: string, limits?: LaminaLimits): Promise<string> {
+    return this._submit({
+      op: 'exec',
+      source: code,
+      limits: limits ?? this._limits
+    }) as Promise<string>
+  }
+
+  /**
+   * Open a session: a context that keeps its state between calls
+   * Sessions are spread over the workers with the fewest sessions
+   * @returns {Promise<LaminaPoolSession>}
+   */
+  async session(): Promise<LaminaPoolSession> {
+    const live = this._workers.filter((w) => !w.dead)
+    if (live.length === 0) {
+      throw new Error('LaminaPool is closed')
+    }
+    const target = live.reduce((a, b) => (b.sessions < a.sessions ? b : a))
+    const id = this._nextSession++
+    target.sessions++
+    try {
+      await this._submit({ op: 'open', session: id }, target)
+    } catch (error) {
+      target.sessions--
+      throw error
+    }
+    return new LaminaPoolSession(this, target, id)
+  }
+
+  /**
+   * Requests waiting for a worker
+   * @returns {number}
+   */
+  get queueDepth(): number {
+    let depth = this._queue.length
+    for (const w of this._workers) {
+      depth += w.pinned.length
+    }
+    return depth
+  }
+
+  /**
+   * Get queue and throughput metrics
+   * @returns {LaminaPoolStats}
+   */
+  stats(): LaminaPoolStats {
+    const live = this._workers.filter((w) => !w.dead)
+    return {
+      workers: live.length,
+      busy: live.filter((w) => w.current).length,
+      queued: this.queueDepth,
+      sessions: live.reduce((n, w) => n + w.sessions, 0),
+      completed: this._completed,
+      failed: this._failed,
+      rejected: this._rejected
+    }
+  }
+
+  /**
+   * Stop all workers; pending calls are rejected
+   */
+  async close(): Promise<void> {
+    if (this._closed) {
+      return
+    }
+    this._closed = true
+    const error = new Error('LaminaPool is closed')
+    const workers = this._workers
+    for (const task of this._queue.splice(0)) {
+      task.reject(error)
+    }
+    for (const w of workers) {
+      this._abandon(w, error)
+    }
+    await Promise.all(workers.map((w) => w.worker.terminate()))
+  }
+
+  /**
+   * Queue a call, on a given worker for sessions
+   * @internal Used by LaminaPoolSession
+   */
+  _submit(call: PoolCall, target?: PoolWorker): Promise<unknown> {
+    if (this._closed) {
+      return Promise.reject(new Error('LaminaPool is closed'))
+    }
+    if (target?.dead) {
+      return Promise.reject(new Error('Session lost: its worker exited'))
+    }
+    if (!this._workers.some((w) => !w.dead)) {
+      return Promise.reject(new Error('LaminaPool has no running workers'))
+    }
+    if (this.queueDepth >= this._maxQueue) {
+      this._rejected++
+      return Promise.reject(new LaminaPoolFullError(this._maxQueue))
+    }
+
+    return new Promise((resolve, reject) => {
+      const task: Task = { call, resolve, reject }
+      if (target) {
+        target.pinned.push(task)
+        this._dispatch(target)
+        return
+      }
+      this._queue.push(task)
+      const idle = this._workers.find((w) => !w.dead && !w.current)
+      if (idle) {
+        this._dispatch(idle)
+      }
+    })
+  }
+
+  private _startWorker(): PoolWorker {
+    const w: PoolWorker = {
+      worker: this._spawn(),
+      current: null,
+      pinned: [],
+      sessions: 0,
+      handled: 0,
+      dead: false
+    }
+    w.worker.on('message', (response: PoolResponse) =>
+      this._settle(w, response)
+    )
+    w.worker.on('error', (error) => this._replace(w, error))
+    w.worker.on('exit', (code) =>
+      this._replace(w, new Error(`Lamina worker exited with code ${code}`))
+    )
+    return w
+  }
+
+  /**
+   * Give an idle worker its next request: its sessions' first
+   */
+  private _dispatch(w: PoolWorker): void {
+    if (w.current || w.dead) {
+      return
+    }
+    const task = w.pinned.shift() ?? this._queue.shift()
+    if (!task) {
+      return
+    }
+    w.current = task
+    w.worker.postMessage({ ...task.call, id: this._nextId++ })
+  }
+
+  private _settle(w: PoolWorker, response: PoolResponse): void {
+    const task = w.current
+    w.current = null
+    w.handled++
+    if (task) {
+      if (response.ok) {
+        this._completed++
+        task.resolve(response.value)
+      } else {
+        this._failed++
+        task.reject(toError(response.error))
+      }
+    }
+    this._dispatch(w)
+  }
+
+  /**
+   * Fail everything bound to a worker that is going away
+   */
+  private _abandon(w: PoolWorker, error: Error): void {
+    w.dead = true
+    w.current?.reject(error)
+    w.current = null
+    for (const task of w.pinned.splice(0)) {
+      task.reject(error)
+    }
+  }
+
+  /**
+   * Replace a worker that crashed; its sessions are lost
+   * Workers that fail before handling anything (e.g. the worker script is
+   * missing) are not restarted, to avoid a restart loop
+   */
+  private _replace(w: PoolWorker, error: Error): void {
+    if (w.dead || this._closed) {
+      return
+    }
+    this._abandon(w, error)
+    if (w.handled === 0) {
+      if (!this._workers.some((other) => !other.dead)) {
+        for (const task of this._queue.splice(0)) {
+          task.reject(error)
+        }
+      }
+      return
+    }
+    const index = this._workers.indexOf(w)
+    const replacement = this._startWorker()
+    this._workers[index] = replacement
+    this._dispatch(replacement)
+  }
+}
+
+/**
+ * Context living on one pool worker
+ * Variables and functions persist across calls until close()
+ */
+export class LaminaPoolSession {
+  private _pool: LaminaPool
+  private _worker: PoolWorker
+  readonly id: number
+  private _closed = false
+
+  /**
+   * @param {LaminaPool} pool - Owning pool
+   * @param {PoolWorker} worker - Worker holding the context
+   * @param {number} id - Session id
+   */
+  constructor(pool: LaminaPool, worker: PoolWorker, id: number) {
+    this._pool = pool
+    this._worker = worker
+    this.id = id
+  }
+
+  /**
+   * Calculate an expression in this session
+   * @param {string} expression
+   * @param {LaminaLimits} limits - Budget for this call only
+   * @returns {Promise<string>} Result
+   */
+  calc(expression: string, limits?: LaminaLimits): Promise<string> {
+    return this._run({
+      op: 'calc',
+      source: expression,
+      session: this.id,
+      limits
+    }) as Promise<string>
+  }
+
+  /**
+   * Execute code in this session
+   * @param {string} code
+   * @param {LaminaLimits} limits - Budget for this call only
+   * @returns {Promise<string>} Output printed by the code
+   */
+  exec(code: string, limits?: LaminaLimits): Promise<string> {
+    return this._run({
+      op: 'exec',
+      source: code,
+      session: this.id,
+      limits
+    }) as Promise<string>
+  }
+
+  /**
+   * Set a variable
+   * @param {string} name
+   * @param {number | string} value
+   */
+  async set(name: string, value: number | string): Promise<void> {
+    await this._run({ op: 'set', name, value, session: this.id })
+  }
+
+  /**
+   * Get a variable
+   * @param {string} name
+   * @returns {Promise<string>}
+   */
+  get(name: string): Promise<string> {
+    return this._run({
+      op: 'get',
+      name,
+      session: this.id
+    }) as Promise<string>
+  }
+
+  /**
+   * Release the session's context on its worker
+   */
+  async close(): Promise<void> {
+    if (this._closed) {
+      return
+    }
+    this._closed = true
+    this._worker.sessions--
+    if (!this._worker.dead) {
+      await this._pool._submit({ op: 'close', session: this.id }, this._worker)
+    }
+  }
+
+  private _run(call: PoolCall): Promise<unknown> {
+    if (this._closed) {
+      return Promise.reject(new Error('Session is closed'))
+    }
+    return this._pool._submit(call, this._worker)
+  }
+}
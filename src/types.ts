@@ -1,15 +1,202 @@
+export interface LaminaRational {
+  type: 'rational'
+  num: bigint
+  den: bigint
+}
+
+export interface LaminaTensor {
+  type: 'array' | 'matrix'
+  data: Float64Array
+  shape: number[]
+}
+
+export interface LaminaSymbolic {
+  type: 'symbolic'
+  text: string
+  approx: number
+}
+
+export interface LaminaOther {
+  type: 'other'
+  text: string
+}
+
+export type LaminaValue =
+  | null
+  | boolean
+  | number
+  | bigint
+  | string
+  | LaminaRational
+  | LaminaTensor
+  | LaminaSymbolic
+  | LaminaOther
+  | LaminaValue[]
+
+export interface LaminaWasmError {
+  type: 'error'
+  message: string
+}
+
+export interface LaminaParseCacheStats {
+  hits: number
+  misses: number
+  entries: number
+  bytes: number
+  maxEntries: number
+  maxBytes: number
+}
+
+export interface LaminaMemoryUsage {
+  live: number
+  peak: number
+  quota: number
+}
+
+export interface LaminaBuiltinProfile {
+  name: string
+  calls: number
+  totalMs: number
+  selfMs: number
+  // Argument counts by Lamina type, e.g. { int: 3, float: 1 }
+  argTypes: Record<string, number>
+}
+
+export interface LaminaLineProfile {
+  // Program the line belongs to, numbered from 1 in the order programs
+  // were first run while profiling
+  source: number
+  line: number
+  // Enclosing user function, or '<main>' for top-level code
+  function: string
+  hits: number
+  timeMs: number
+  allocations: number
+}
+
+// A complete event in Chrome Trace Event format, timestamps in microseconds
+export interface LaminaTraceEvent {
+  ph: string
+  cat?: string
+  name: string
+  pid: number
+  tid: number
+  ts?: number
+  dur?: number
+  args?: Record<string, unknown>
+}
+
+export interface LaminaSnapshot {
+  delete(): void
+}
+
+export interface LaminaInterpreterPoolStats {
+  capacity: number
+  idle: number
+  created: number
+  acquired: number
+  reused: number
+}
+
+export interface LaminaWasmBatch {
+  data: Uint8Array
+  offsets: Uint32Array
+  // ErrorKind of each expression, 0 when it succeeded
+  errors: Uint8Array
+}
+
 export interface LaminaWasmInterpreter {
   execute(code: string): string
   eval(expression: string): string
+  executeStatus(code: string): number
+  evalStatus(expression: string): number
+  // Result string, or the ErrorKind of the failure
+  evalString(expression: string): string | number
+  // Only in the JSPI build and the Node-API addon
+  executeAsync?(
+    code: string,
+    sliceSteps: number,
+    sliceMs: number
+  ): Promise<number>
+  lastYieldCount(): number
+  executeBytes(source: number, length: number): number
+  appendSource(chunk: number, length: number): void
+  finishSource(): number
+  discardSource(): void
+  resultString(): string
+  resultValue(): LaminaValue
+  errorKind(): number
+  errorMessage(): string
+  errorOffset(): number
+  evalValue(expression: string): LaminaValue | LaminaWasmError
+  compile(expression: string): number
+  evaluate(handle: number): string
+  // Result string, or the ErrorKind of the failure
+  evaluateString(handle: number): string | number
+  evaluateColumns(
+    handle: number,
+    names: number,
+    nameOffsets: number,
+    columns: number,
+    columnCount: number,
+    rows: number,
+    out: number
+  ): number
+  release(handle: number): void
+  getLastError(): string
+  setLimits(maxSteps: number, timeoutMs: number): void
+  lastStepCount(): number
+  setMemoryQuota(bytes: number): void
+  memoryUsage(): LaminaMemoryUsage
+  setProfiling(enabled: boolean): void
+  getProfile(): LaminaBuiltinProfile[]
+  resetProfile(): void
+  setLineProfiling(enabled: boolean): void
+  getLineProfile(): LaminaLineProfile[]
+  getCollapsedStacks(): string
+  resetLineProfile(): void
+  startTrace(capacity: number, slowBuiltinMs: number): void
+  stopTrace(): void
+  exportTrace(): string
+  clearTrace(): void
+  enableParseCache(maxEntries: number, maxBytes: number): void
+  disableParseCache(): void
+  getParseCacheStats(): LaminaParseCacheStats
+  setOutputCapture(enabled: boolean): void
+  takeOutput(): string
+  outputView(): Uint8Array
+  clearOutput(): void
+  evalBatch(source: number, offsets: number, count: number): LaminaWasmBatch
   setVariable(name: string, value: number): void
   setStringVariable(name: string, value: string): void
+  bindVariables(
+    names: number,
+    nameOffsets: number,
+    values: number,
+    count: number
+  ): void
+  bindArray(name: string, data: number, length: number, isInt: boolean): void
   getVariable(name: string): string
+  getVariableValue(name: string): LaminaValue | LaminaWasmError
   reset(): void
+  snapshot(): LaminaSnapshot
+  restore(snapshot: LaminaSnapshot): void
+  fork(): LaminaWasmInterpreter
   delete(): void
 }
 
 export interface LaminaWasmModule {
   LaminaInterpreter: new () => LaminaWasmInterpreter
   evaluateExpression(expression: string): string
+  evaluateExpressionValue(expression: string): LaminaValue | LaminaWasmError
   executeCode(code: string): string
+  setInterpreterPoolSize(size: number): void
+  getInterpreterPoolStats(): LaminaInterpreterPoolStats
+  warmUp(): void
+  _malloc(size: number): number
+  _free(ptr: number): void
+  HEAPU8: Uint8Array
+  HEAPU32: Uint32Array
+  HEAP32: Int32Array
+  HEAPF64: Float64Array
 }